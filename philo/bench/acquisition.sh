@@ -0,0 +1,46 @@
+#!/bin/sh
+# Compares the blocking and backoff fork acquisition modes (PHILO_ACQUISITION)
+# at high contention: meal throughput, worst-case hunger (the longest time a
+# philosopher went without starting a meal) and deaths.
+# usage: bench/acquisition.sh [runs]
+
+cd "$(dirname "$0")/.." || exit 1
+RUNS="${1:-3}"
+OUT="$(mktemp)"
+trap 'rm -f "$OUT"' EXIT
+
+# Prints "<meals> <last timestamp> <worst hunger> <deaths>" for a log.
+summarize() {
+	awk '
+	$3 == "is" && $4 == "eating" {
+		meals++;
+		gap = $1 - last[$2];
+		if (gap > worst)
+			worst = gap;
+		last[$2] = $1;
+	}
+	$3 == "died" { died++ }
+	{ end = $1 }
+	END { printf("%d %d %d %d\n", meals, end, worst, died) }' "$1"
+}
+
+printf "%-22s %-9s %-10s %-12s %s\n" \
+	"scenario" "mode" "meals/s" "worst_hunger" "deaths"
+for scenario in "5 800 200 200 20" "4 410 200 200 20" "200 800 200 200 10" \
+	"199 610 200 200 10"
+do
+	for mode in blocking backoff
+	do
+		meals=0; span=0; worst=0; deaths=0; run=0
+		while [ "$run" -lt "$RUNS" ]
+		do
+			PHILO_ACQUISITION="$mode" ./philo $scenario > "$OUT"
+			set -- $(summarize "$OUT")
+			meals=$((meals + $1)); span=$((span + $2)); deaths=$((deaths + $4))
+			[ "$3" -gt "$worst" ] && worst=$3
+			run=$((run + 1))
+		done
+		printf "%-22s %-9s %-10s %-12s %s\n" "$scenario" "$mode" \
+			"$((meals * 1000 / (span > 0 ? span : 1)))" "$worst" "$deaths"
+	done
+done
@@ -0,0 +1,50 @@
+#!/bin/sh
+# Compares the survival of a tight table with the default safety margins
+# of the sleeps and with the margins calibrated for this host
+# (PHILO_CALIBRATION). The host is measured once, on a table that dies
+# at once, and the calibrated runs load the file; the start up time with
+# the measure and with the file is shown. Each run must eat a few meals
+# and counts as a death if anyone died.
+# usage: bench/calibration.sh [runs] [philosophers time_to_die eat sleep]
+
+cd "$(dirname "$0")/.." || exit 1
+RUNS="${1:-20}"
+[ "$#" -gt 0 ] && shift
+ARGS="${*:-4 410 200 200}"
+FILE="$(mktemp)"
+OUT="$FILE.out"
+trap 'rm -f "$FILE" "$OUT" "$OUT.err"' EXIT
+
+rm -f "$FILE"
+for cache in measured cached
+do
+	start="$(date +%s%N)"
+	# shellcheck disable=SC2086
+	PHILO_CALIBRATION="$FILE" ./philo ${ARGS%% *} 1 1 1 > /dev/null \
+		2> "$OUT.err"
+	printf "calibration %-8s %6d ms\n" "$cache" \
+		$(( ($(date +%s%N) - start) / 1000000 ))
+done
+printf "%-11s %-6s %-7s %s\n" "margins" "runs" "deaths" "survival"
+for mode in default calibrated
+do
+	deaths=0
+	i=0
+	while [ "$i" -lt "$RUNS" ]
+	do
+		if [ "$mode" = calibrated ]
+		then
+			# shellcheck disable=SC2086
+			PHILO_CALIBRATION="$FILE" timeout -s INT 30 ./philo $ARGS 10 \
+				> "$OUT" 2> "$OUT.err"
+		else
+			# shellcheck disable=SC2086
+			timeout -s INT 30 ./philo $ARGS 10 > "$OUT" 2> "$OUT.err"
+		fi
+		grep -q " died$" "$OUT" && deaths=$(( deaths + 1 ))
+		i=$(( i + 1 ))
+	done
+	printf "%-11s %-6d %-7d %d%%\n" "$mode" "$RUNS" "$deaths" \
+		$(( (RUNS - deaths) * 100 / RUNS ))
+done
+grep "^calibration:" "$OUT.err"
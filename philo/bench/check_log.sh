@@ -0,0 +1,90 @@
+#!/bin/sh
+# Checks the invariants of a ./philo output with the default ring of forks.
+# Safety violations are printed and make the script fail:
+#   - timestamps never go back, and nothing is printed after a death;
+#   - every philosopher goes fork, fork, eating, sleeping, thinking, in
+#     that order, and never eats with fewer than two forks;
+#   - two neighbors never eat at the same time;
+#   - nobody dies before time_to_die without a meal;
+#   - without a death, everybody eats number_of_times_each_must_eat times.
+# Timing is only summarized, on the last line, since injected noise and
+# CPU oversubscription can legitimately make deaths late: the meals, the
+# deaths, the death-detection latency and the number of starvations
+# (more than time_to_die without a meal) that were not reported in time.
+# usage: bench/check_log.sh <philosophers> <time_to_die> <must_eat|-1> <log>
+
+if [ $# -ne 4 ]; then
+	echo "usage: $0 <philosophers> <time_to_die> <must_eat|-1> <log>" >&2
+	exit 2
+fi
+
+awk -v n="$1" -v die="$2" -v must="$3" '
+function fail(message) {
+	printf("line %d: %s: %s\n", NR, message, $0);
+	failures++;
+}
+function neighbor_eating(p) {
+	return (state[p == 1 ? n : p - 1] == "eating" \
+		|| state[p == n ? 1 : p + 1] == "eating");
+}
+function check_starvation(p, t) {
+	if (t - last[p] > die + 10)
+		missed++;
+}
+$1 !~ /^[0-9]+$/ || $2 !~ /^[0-9]+$/ { fail("unexpected output"); next }
+{
+	t = $1; p = $2;
+	if (t < previous)
+		fail("timestamp goes back");
+	previous = t;
+	if (dead)
+		fail("output after a death");
+	if (p < 1 || p > n)
+		fail("unknown philosopher");
+}
+$3 == "has" {
+	if (state[p] != "" && state[p] != "thinking" && state[p] != "fork")
+		fail("fork taken while " state[p]);
+	if (++forks[p] > 2)
+		fail("more than two forks");
+	state[p] = "fork";
+}
+$3 == "is" && $4 == "eating" {
+	if (forks[p] != 2)
+		fail("eating with " forks[p] + 0 " forks");
+	if (neighbor_eating(p))
+		fail("eating next to an eating neighbor");
+	check_starvation(p, t);
+	state[p] = "eating"; last[p] = t; meals[p]++; total++;
+}
+$3 == "is" && $4 == "sleeping" {
+	if (state[p] != "eating")
+		fail("sleeping without eating");
+	state[p] = "sleeping"; forks[p] = 0;
+}
+$3 == "is" && $4 == "thinking" {
+	if (state[p] != "" && state[p] != "sleeping")
+		fail("thinking while " state[p]);
+	state[p] = "thinking";
+}
+$3 == "died" {
+	if (t - last[p] < die)
+		fail("died " die - (t - last[p]) "ms early");
+	latency = t - last[p] - die;
+	dead = 1;
+}
+END {
+	if (!dead && must >= 0)
+		for (p = 1; p <= n; p++)
+			if (meals[p] < must) {
+				printf("end: philosopher %d ate %d times out of %d\n", p,
+					meals[p], must);
+				failures++;
+			}
+	if (!dead)
+		for (p = 1; p <= n; p++)
+			check_starvation(p, previous);
+	printf("meals=%d deaths=%d latency_ms=%s missed_starvations=%d\n",
+		total, dead, dead ? latency : "-", missed);
+	exit(failures > 0);
+}' "$4"
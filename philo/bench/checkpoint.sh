@@ -0,0 +1,35 @@
+#!/bin/sh
+# Measures the cost of the checkpoints (PHILO_CHECKPOINT) as the table
+# grows: each run takes one every 100 ms for a few seconds after the
+# start, then is stopped by SIGINT, which takes a last one. The cost is
+# given on the wall clock and in CPU time of the checkpoint thread, which
+# leaves out the time it was preempted; the philosophers themselves never
+# wait for a checkpoint. Then resumes the last table from its checkpoint
+# and prints the first meals of the resumed run.
+# usage: bench/checkpoint.sh [seconds]
+
+cd "$(dirname "$0")/.." || exit 1
+SECONDS_RUN="${1:-3}"
+OUT="$(mktemp)"
+FILE="$OUT.checkpoint"
+trap 'rm -f "$OUT" "$OUT.err" "$FILE"' EXIT
+
+printf "%-7s %-6s %-11s %-11s %-10s %-8s %s\n" "philo" "taken" \
+	"longest_us" "cpu_us" "mean_us" "retries" "file_bytes"
+for n in 10 100 250 1000
+do
+	rm -f "$FILE"
+	PHILO_CHECKPOINT="$FILE" PHILO_CHECKPOINT_INTERVAL_MS=100 \
+		PHILO_MAX_PHILOSOPHERS="$n" timeout -s INT \
+		"$(( n / 50 + SECONDS_RUN ))" ./philo "$n" 4000 200 200 \
+		> /dev/null 2> "$OUT"
+	awk -v n="$n" -v size="$(wc -c < "$FILE")" '
+	$1 == "checkpoint:" {
+		printf("%-7d %-6d %-11s %-11s %-10s %-8s %d\n", n, $2, $5, $8,
+			$11, $14, size)
+	}' "$OUT"
+done
+PHILO_RESUME="$FILE" PHILO_MAX_PHILOSOPHERS=1000 timeout -s INT \
+	"$(( 1000 / 50 + 1 ))" ./philo 1000 4000 200 200 > "$OUT" 2> "$OUT.err"
+head -n 1 "$OUT.err"
+head -n 6 "$OUT"
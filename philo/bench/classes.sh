@@ -0,0 +1,25 @@
+#!/bin/sh
+# Runs a mixed table of slow and fast philosophers (PHILO_TIMINGS) with
+# each fork acquisition mode, and prints the report of the "classes"
+# profile: the meal rate, fairness, worst hunger and deaths of each class.
+# usage: bench/classes.sh [philosophers] [slow_philosophers] [jitter_ms]
+
+cd "$(dirname "$0")/.." || exit 1
+N="${1:-20}"
+SLOW="${2:-5}"
+JITTER="${3:-20}"
+TIMINGS="$(mktemp)"
+trap 'rm -f "$TIMINGS"' EXIT
+
+{
+	echo "# slow philosophers: long meals, more patience"
+	echo "1 $SLOW 1200 300 200 $JITTER"
+	echo "# fast philosophers: short meals, jittered"
+	echo "$((SLOW + 1)) $N 600 100 100 $JITTER"
+} > "$TIMINGS"
+for mode in blocking backoff
+do
+	echo "# acquisition=$mode"
+	PHILO_TIMINGS="$TIMINGS" PHILO_PROFILE=classes PHILO_ACQUISITION="$mode" \
+		./philo "$N" 800 200 200 10 2>&1 > /dev/null | grep "^classes:"
+done
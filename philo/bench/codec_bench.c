@@ -0,0 +1,213 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   codec_bench.c                                      :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: antestem <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/07/11 17:02:02 by antestem          #+#    #+#             */
+/*   Updated: 2024/07/11 17:02:03 by antestem         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "philosophers.h"
+#include <time.h>
+
+/* now_ns:
+ *   Returns the monotonic clock in nanoseconds.
+ */
+static long	now_ns(void)
+{
+	struct timespec	ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec * 1000000000L + ts.tv_nsec);
+}
+
+/* compare_events:
+ *   Orders events by time, as the output thread prints them.
+ */
+static int	compare_events(const void *a, const void *b)
+{
+	const t_output_event	*first = a;
+	const t_output_event	*second = b;
+
+	return ((first->time > second->time) - (first->time < second->time));
+}
+
+/* make_events:
+ *   Makes the events of a table that runs like 200 800 200 200 would:
+ *   every 400 ms, the even philosophers take their forks and eat, then
+ *   the odd ones 200 ms later, each one sleeping after his meal and
+ *   thinking after his nap, a millisecond or two late now and then.
+ *
+ *   Returns:
+ *     - The events in time order, 5 per philosopher and round.
+ */
+static t_output_event	*make_events(t_dining_table *table, size_t count)
+{
+	t_output_event	*events;
+	size_t			i;
+	uint64_t		meal;
+
+	events = calloc(count, sizeof(t_output_event));
+	i = 0;
+	while (events && i < count)
+	{
+		meal = (uint64_t)(table->start_time + i / 5 / table->num_philosophers
+				* 400 + i / 5 % table->num_philosophers % 2 * 200
+				+ i * 2654435761U % 7 / 5) * 1000000 + i % 5;
+		events[i].philosopher = i / 5 % table->num_philosophers;
+		events[i].status = (t_philosopher_status[]){PHILO_GOT_FORK,
+			PHILO_GOT_FORK, PHILO_EATING, PHILO_SLEEPING,
+			PHILO_THINKING}[i % 5];
+		events[i].time = meal + (i % 5 > 2) * (i % 5 - 2) * 200000000UL;
+		i++;
+	}
+	if (events)
+		qsort(events, count, sizeof(t_output_event), &compare_events);
+	return (events);
+}
+
+/* compress_events:
+ *   Compresses the events the way the output thread does, into a file
+ *   standing in for the standard output.
+ *
+ *   Returns:
+ *     - The time it took, in nanoseconds.
+ */
+static long	compress_events(t_dining_table *table, t_output_event *events,
+		size_t count, FILE *file)
+{
+	long	start;
+	int		saved;
+	size_t	i;
+
+	fflush(stdout);
+	saved = dup(STDOUT_FILENO);
+	dup2(fileno(file), STDOUT_FILENO);
+	start = now_ns();
+	i = 0;
+	while (i < count)
+		encode_output_event(table, &events[i++]);
+	finish_output_codec(&table->output);
+	start = now_ns() - start;
+	dup2(saved, STDOUT_FILENO);
+	close(saved);
+	return (start);
+}
+
+/* decompress_file:
+ *   Decodes the compressed output back into text, as bench/unpack does.
+ *
+ *   Returns:
+ *     - The time it took in nanoseconds, or -1 if a block was refused.
+ */
+static long	decompress_file(FILE *file, FILE *text)
+{
+	t_output_codec	codec;
+	unsigned char	block[OUTPUT_BUFFER_SIZE];
+	uint32_t		compressed;
+	long			start;
+
+	memset(&codec, 0, sizeof(t_output_codec));
+	codec.block = malloc(CODEC_BLOCK_SIZE);
+	rewind(file);
+	start = now_ns();
+	compressed = 1;
+	if (!codec.block || fread(block, 1, 4, file) != 4)
+		compressed = 0;
+	while (compressed > 0
+		&& fread(block, 1, CODEC_HEADER_SIZE, file) == CODEC_HEADER_SIZE)
+	{
+		compressed = block[4] | block[5] << 8 | block[6] << 16
+			| (uint32_t)block[7] << 24;
+		if (compressed > 0 && (fread(block + CODEC_HEADER_SIZE, 1,
+					compressed, file) != compressed
+				|| !decode_output_block(&codec, block, text)))
+			start = now_ns() + 1;
+	}
+	start = now_ns() - start;
+	free(codec.block);
+	return (start);
+}
+
+/* run_bench:
+ *   Compresses the events, decompresses them, and checks that the text
+ *   is exactly the plain output's. Prints the compression ratio and the
+ *   speed of both directions in MB of text per second.
+ */
+static void	run_bench(t_dining_table *table, t_output_event *events,
+		size_t count)
+{
+	FILE	*files[2];
+	char	*texts[2];
+	size_t	lengths[2];
+	long	times[2];
+	size_t	i;
+
+	files[0] = tmpfile();
+	files[1] = open_memstream(&texts[1], &lengths[1]);
+	texts[0] = malloc(count * OUTPUT_LINE_MAX);
+	if (!files[0] || !files[1] || !texts[0])
+		return ;
+	lengths[0] = 0;
+	i = 0;
+	while (i < count)
+		lengths[0] += format_event(table, &events[i++], texts[0] + lengths[0]);
+	times[0] = compress_events(table, events, count, files[0]);
+	times[1] = decompress_file(files[0], files[1]);
+	fclose(files[1]);
+	printf("{\"philosophers\": %u, \"events\": %zu, \"text_bytes\": %zu, "
+		"\"compressed_bytes\": %lu, \"ratio\": %.2f, \"compress_mb_s\": %.1f, "
+		"\"decompress_mb_s\": %.1f, \"exact\": %s}\n", table->num_philosophers,
+		count, lengths[0], table->output.codec.compressed_bytes,
+		(double)lengths[0] / table->output.codec.compressed_bytes,
+		lengths[0] * 1000.0 / times[0], lengths[0] * 1000.0 / times[1],
+		(char *[]){"false", "true"}[times[1] >= 0 && lengths[0] == lengths[1]
+		&& memcmp(texts[0], texts[1], lengths[0]) == 0]);
+	fclose(files[0]);
+	free(texts[0]);
+	free(texts[1]);
+}
+
+/* main:
+ *   usage: codec_bench [philosophers] [rounds]
+ *   Measures the codec of the "compressed" output on its own, on the
+ *   events of a simulated table, without threads.
+ */
+int	main(int argc, char **argv)
+{
+	t_dining_table	*table;
+	t_output_event	*events;
+	t_settings		settings;
+
+	init_default_settings(&settings);
+	settings.num_philosophers = 200;
+	settings.time_to_die = 800;
+	settings.time_to_eat = 200;
+	settings.time_to_sleep = 200;
+	settings.must_eat_count = 500;
+	if (argc > 1)
+		settings.num_philosophers = atol(argv[1]);
+	if (argc > 2)
+		settings.must_eat_count = atol(argv[2]);
+	settings.max_philosophers = PHILOSOPHERS_LIMIT;
+	settings.writer = WRITER_MERGED;
+	settings.output_mode = OUTPUT_COMPRESSED;
+	if (settings.num_philosophers < 1 || settings.must_eat_count < 1)
+		return (EXIT_FAILURE);
+	table = init_dining_table(&settings);
+	if (!table)
+		return (EXIT_FAILURE);
+	table->start_time = get_current_time_in_ms();
+	events = make_events(table, (size_t)settings.num_philosophers
+			* settings.must_eat_count * 5);
+	if (events)
+		run_bench(table, events, (size_t)settings.num_philosophers
+			* settings.must_eat_count * 5);
+	free(events);
+	destroy_all_mutexes(table);
+	free_dining_table(table);
+	return (EXIT_SUCCESS);
+}
@@ -0,0 +1,211 @@
+#!/bin/sh
+# Compares two runs of philo, A and B: two event logs (compressed ones
+# are unpacked with bench/unpack), or two result files of bench/run.sh or
+# bench/scenarios.sh, with several runs of each scenario for the numbers
+# to mean something. A log gives meals per second, the mean over the
+# philosophers of their median and 99th percentile hunger (the time
+# between the starts of two meals), the fairness of the meals (Jain's
+# index, 1 when all ate as much) and the death, if any. A result file
+# gives each scenario's and micro-benchmark's timings, deaths and meals.
+# The 95% confidence interval of B - A is bootstrapped over the
+# philosophers of a log, or over the runs of a result file, and a metric
+# whose interval leaves 0 on the wrong side is a regression. A metric
+# with fewer than 5 samples on a side, like the death of a log, is shown
+# but not judged: the bootstrap of a few runs is too narrow to trust.
+# Exits with 1 if there is a regression.
+# usage: bench/compare.sh [-r resamples] [-s seed] <a> <b>
+
+RESAMPLES=1000
+SEED=42
+while getopts "r:s:" option
+do
+	case "$option" in
+		r) RESAMPLES="$OPTARG" ;;
+		s) SEED="$OPTARG" ;;
+		*) exit 2 ;;
+	esac
+done
+shift $((OPTIND - 1))
+if [ $# -ne 2 ] || [ ! -r "$1" ] || [ ! -r "$2" ]; then
+	echo "usage: $0 [-r resamples] [-s seed] <a> <b>" >&2
+	exit 2
+fi
+UNPACK="$(dirname "$0")/unpack"
+A="$(mktemp)"
+B="$(mktemp)"
+trap 'rm -f "$A" "$B"' EXIT
+
+# Prints the kind of a file: "results", "compressed" or "log".
+kind() {
+	if [ "$(head -c 4 "$1")" = "PLZ1" ]; then
+		echo compressed
+	elif [ "$(awk 'NF { print substr($1, 1, 1); exit }' "$1")" = "{" ]; then
+		echo results
+	else
+		echo log
+	fi
+}
+
+# Prints the samples of a log, "<metric> <better> <statistic> <value>"
+# per line, one of each metric per philosopher: the statistic of the
+# metric is the sum or the mean of the samples, or Jain's index. The
+# hunger of a philosopher who died or never ate runs to the end of the
+# log.
+log_samples() {
+	awk '
+	function percentile(x, n, p,    i, j, v, rank) {
+		for (i = 2; i <= n; i++) {
+			v = x[i];
+			for (j = i - 1; j >= 1 && x[j] > v; j--)
+				x[j + 1] = x[j];
+			x[j + 1] = v;
+		}
+		rank = int(p * n + 0.999999);
+		return (x[rank < 1 ? 1 : rank]);
+	}
+	$1 !~ /^[0-9]+$/ || $2 !~ /^[0-9]+$/ { next }
+	{ end = $1; if ($2 > n) n = $2 }
+	$3 == "is" && $4 == "eating" {
+		hunger[$2, ++meals[$2]] = $1 - last[$2];
+		last[$2] = $1;
+	}
+	$3 == "died" && !died++ { death = $1; latency = $1 - last[$2]; dead = $2 }
+	END {
+		if (end < 1)
+			end = 1;
+		for (p = 1; p <= n; p++) {
+			printf("meals_per_sec + sum %.3f\n", meals[p] * 1000 / end);
+			printf("fairness + jain %d\n", meals[p]);
+			gaps = meals[p];
+			if (p == dead || !gaps)
+				hunger[p, ++gaps] = end - last[p];
+			for (i = 1; i <= gaps; i++)
+				x[i] = hunger[p, i];
+			printf("hunger_p50_ms - mean %d\n", percentile(x, gaps, 0.5));
+			printf("hunger_p99_ms - mean %d\n", percentile(x, gaps, 0.99));
+		}
+		printf("deaths - single %d\n", died > 0);
+		if (died) {
+			printf("death_at_ms + single %d\n", death);
+			printf("death_hunger_ms - single %d\n", latency);
+		}
+	}' "$1"
+}
+
+# Prints the samples of a result file, one of each metric per run, named
+# after the scenario or the micro-benchmark.
+results_samples() {
+	awk '
+	function field(name,    value) {
+		if (!match($0, "\"" name "\": [-0-9.]+"))
+			return ("");
+		value = substr($0, RSTART, RLENGTH);
+		return (substr(value, index(value, ":") + 2));
+	}
+	function sample(name, better,    value) {
+		value = field(name);
+		if (value != "")
+			printf("%s.%s %s mean %s\n", key, name, better, value);
+	}
+	match($0, /"name": "[^"]*"/) {
+		key = substr($0, RSTART + 9, RLENGTH - 10);
+		sample("meals_per_sec", "+");
+		sample("wall_ms", "-");
+		sample("cpu_ms", "-");
+		sample("deaths", "-");
+		sample("death_latency_ms", "-");
+		sample("involuntary_ctxsw", "-");
+		sample("ns_per_call", "-");
+		sample("mean_oversleep_us", "-");
+	}' "$1"
+}
+
+# Writes the samples of an input to a file.
+samples() {
+	case "$(kind "$1")" in
+		compressed) "$UNPACK" < "$1" > "$2.log" && log_samples "$2.log" ;;
+		results) results_samples "$1" ;;
+		*) log_samples "$1" ;;
+	esac > "$2"
+	status=$?
+	rm -f "$2.log"
+	return $status
+}
+
+if [ "$(kind "$1" | sed s/compressed/log/)" \
+	!= "$(kind "$2" | sed s/compressed/log/)" ]; then
+	echo "$0: cannot compare a log with a result file" >&2
+	exit 2
+fi
+samples "$1" "$A" && samples "$2" "$B" || exit 2
+
+awk -v resamples="$RESAMPLES" -v seed="$SEED" '
+function statistic(kind, side, k, pick, n,    i, j, v, sum, squares) {
+	sum = 0;
+	squares = 0;
+	for (i = 1; i <= n; i++) {
+		j = pick ? int(rand() * n) + 1 : i;
+		v = values[side, k, j];
+		sum += v;
+		squares += v * v;
+	}
+	if (kind == "sum")
+		return (sum);
+	if (kind == "jain")
+		return (squares > 0 ? sum * sum / (n * squares) : 1);
+	return (sum / n);
+}
+function sort(x, n,    i, j, v) {
+	for (i = 2; i <= n; i++) {
+		v = x[i];
+		for (j = i - 1; j >= 1 && x[j] > v; j--)
+			x[j + 1] = x[j];
+		x[j + 1] = v;
+	}
+}
+FNR == 1 { side++ }
+{
+	if (!(($1) in better)) {
+		order[++keys] = $1;
+		better[$1] = $2;
+		kind[$1] = $3;
+	}
+	values[side, $1, ++count[side, $1]] = $4;
+}
+END {
+	srand(seed);
+	printf("%-36s %11s %11s %8s %23s  %s\n", "metric", "a", "b", "change",
+		"ci95 of b - a", "verdict");
+	for (i = 1; i <= keys; i++) {
+		k = order[i];
+		na = count[1, k];
+		nb = count[2, k];
+		a = na ? sprintf("%.3f", statistic(kind[k], 1, k, 0, na)) : "-";
+		b = nb ? sprintf("%.3f", statistic(kind[k], 2, k, 0, nb)) : "-";
+		change = "-";
+		if (na && nb && a + 0 != 0)
+			change = sprintf("%+.1f%%", (b - a) * 100 / a);
+		verdict = "-";
+		interval = "-";
+		if (kind[k] != "single" && na >= 5 && nb >= 5) {
+			for (r = 1; r <= resamples; r++) {
+				b_sample = statistic(kind[k], 2, k, 1, nb);
+				diff[r] = b_sample - statistic(kind[k], 1, k, 1, na);
+			}
+			sort(diff, resamples);
+			low = diff[int(resamples * 0.025) + 1];
+			high = diff[int(resamples * 0.975)];
+			interval = sprintf("[%.3f, %.3f]", low, high);
+			verdict = "same";
+			if ((low > 0 && better[k] == "-") || (high < 0 && better[k] == "+"))
+				verdict = "REGRESSION";
+			else if (low > 0 || high < 0)
+				verdict = "improvement";
+			regressions += verdict == "REGRESSION";
+		}
+		printf("%-36s %11s %11s %8s %23s  %s\n", k, a, b, change, interval,
+			verdict);
+	}
+	printf("regressions=%d\n", regressions);
+	exit(regressions > 0);
+}' "$A" "$B"
@@ -0,0 +1,30 @@
+#!/bin/sh
+# Measures the "compressed" output (PHILO_OUTPUT=compressed): runs a big
+# table with the merged writer in plain and compressed output, compares
+# the sizes of the two logs, unpacks the compressed one with bench/unpack
+# and checks it like any other log (see check_log.sh). Then measures the
+# codec on its own with bench/codec_bench.
+# usage: bench/compression.sh [philosophers] [meals]
+
+cd "$(dirname "$0")/.." || exit 1
+N="${1:-200}"
+MEALS="${2:-20}"
+PLAIN="$(mktemp)"
+PACKED="$(mktemp)"
+UNPACKED="$(mktemp)"
+trap 'rm -f "$PLAIN" "$PACKED" "$UNPACKED"' EXIT
+
+make -s bench/unpack bench/codec_bench || exit 1
+PHILO_WRITER=merged timeout -s INT 60 ./philo "$N" 800 200 200 "$MEALS" \
+	> "$PLAIN" 2> /dev/null
+PHILO_WRITER=merged PHILO_OUTPUT=compressed timeout -s INT 60 \
+	./philo "$N" 800 200 200 "$MEALS" 2> /dev/stdout > "$PACKED" \
+	| grep "^compression:"
+./bench/unpack < "$PACKED" > "$UNPACKED" || exit 1
+printf "plain: %d bytes, compressed: %d bytes, ratio %s\n" \
+	"$(wc -c < "$PLAIN")" "$(wc -c < "$PACKED")" \
+	"$(awk -v p="$(wc -c < "$PLAIN")" -v c="$(wc -c < "$PACKED")" \
+	'BEGIN { printf("%.2f", p / c) }')"
+sh bench/check_log.sh "$N" 800 "$MEALS" "$UNPACKED" || exit 1
+./bench/codec_bench "$N" 500
+./bench/codec_bench 5 2000
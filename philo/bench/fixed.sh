@@ -0,0 +1,48 @@
+#!/bin/sh
+# Compares a generic build of ./philo with a fixed build (FIXED in the
+# Makefile) specialized for the benchmarked parameters. Both are built here
+# with the same flags; prints one JSON object per build and run with the CPU
+# time spent per printed event, on an output-heavy scenario. Needs
+# bench/rusage, which "make bench" builds.
+# usage: bench/fixed.sh [runs] [philosophers time_to_die time_to_eat
+#        time_to_sleep must_eat]
+
+cd "$(dirname "$0")/.." || exit 1
+RUNS="${1:-3}"
+[ "$#" -gt 0 ] && shift
+SCENARIO="${*:-20 200 10 10 100}"
+set -- $SCENARIO
+LOCK="$(echo "${FORK_LOCK:-mutex}" | tr 'a-z' 'A-Z')"
+BIN="$(mktemp -d)"
+OUT="$(mktemp)"
+trap 'rm -rf "$BIN" "$OUT"' EXIT
+
+for build in generic fixed
+do
+	FLAGS=""
+	[ "$build" = fixed ] && FLAGS="-DFIXED_PHILOSOPHERS=$1 \
+		-DFIXED_TIME_TO_DIE=$2 -DFIXED_TIME_TO_EAT=$3 -DFIXED_TIME_TO_SLEEP=$4 \
+		-DFIXED_MUST_EAT=${5:--1} -DFIXED_DESCRIPTION=\"\\\"$SCENARIO\\\"\""
+	eval gcc -O2 -Wall -Wextra -Werror -pthread -I includes \
+		-DFORK_LOCK=FORK_LOCK_"$LOCK" $FLAGS srcs/*.c -o "$BIN/$build" \
+		|| exit 1
+done
+run=0
+while [ "$run" -lt "$RUNS" ]
+do
+	for build in generic fixed
+	do
+		set -- $(bench/rusage "$OUT" "$BIN/$build" $SCENARIO)
+		awk -v build="$build" -v run="$run" -v status="$1" -v wall="$2" \
+			-v cpu="$(($3 + $4))" -v events="$(wc -l < "$OUT")" \
+			'BEGIN {
+			printf("{\"build\": \"%s\", \"run\": %d, ", build, run);
+			printf("\"exit_status\": %d, \"wall_ms\": %.1f, ", status,
+				wall / 1000);
+			printf("\"cpu_ms\": %.1f, \"events\": %d, ", cpu / 1000, events);
+			printf("\"cpu_ns_per_event\": %d}\n",
+				cpu * 1000 / (events > 0 ? events : 1));
+			}'
+	done
+	run=$((run + 1))
+done
@@ -0,0 +1,32 @@
+#!/bin/sh
+# Compares the memory used by the default and "low" footprint modes
+# (PHILO_FOOTPRINT) as the table grows, from the report of the "memory"
+# profile. Prints one JSON object per run and line with the peak resident
+# and virtual sizes per philosopher.
+# usage: bench/footprint.sh [stack_size_kb]
+
+cd "$(dirname "$0")/.." || exit 1
+STACK="${1:-64}"
+OUT="$(mktemp)"
+trap 'rm -f "$OUT"' EXIT
+
+for n in 100 500 2000
+do
+	for footprint in default low
+	do
+		PHILO_FOOTPRINT="$footprint" PHILO_PROFILE=memory \
+			PHILO_STACK_SIZE_KB="$STACK" PHILO_MAX_PHILOSOPHERS="$n" \
+			./philo "$n" 60000 10 10 1 2> "$OUT" > /dev/null
+		status=$?
+		awk -v n="$n" -v footprint="$footprint" -v status="$status" '
+		$2 == "peak_rss" { rss = $4 }
+		$2 == "peak_virtual" { virtual = $4 }
+		END {
+			printf("{\"philosophers\": %d, \"footprint\": \"%s\", ", n,
+				footprint);
+			printf("\"exit_status\": %d, \"rss_kb_per_philosopher\": %s, ",
+				status, rss);
+			printf("\"virtual_kb_per_philosopher\": %s}\n", virtual);
+		}' "$OUT"
+	done
+done
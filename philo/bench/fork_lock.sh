@@ -0,0 +1,27 @@
+#!/bin/sh
+# Builds bench/fork_lock_bench.c once per FORK_LOCK implementation and
+# reports handoff latency and CPU cost at several thread counts, to pick
+# the fork lock that suits the host's core count.
+# usage: bench/fork_lock.sh [handoffs] [hold_us]
+
+cd "$(dirname "$0")/.." || exit 1
+HANDOFFS="${1:-2000}"
+HOLD_US="${2:-200}"
+BIN="$(mktemp)"
+THREADS="$(printf "%s\n" 2 4 "$(nproc)" $(( $(nproc) * 2 )) | sort -nu)"
+trap 'rm -f "$BIN"' EXIT
+
+echo "# $(nproc) cores, $HANDOFFS handoffs, fork held for ${HOLD_US}us"
+printf "%-9s %-7s %-8s %-9s %-9s %-10s %-9s %s %s\n" "lock" "threads" \
+	"handoffs" "p50_ns" "p99_ns" "max_ns" "wall_ms" "cpu/wall" "ctxsw"
+for lock in MUTEX ADAPTIVE TICKET MCS
+do
+	gcc -O2 -Wall -Wextra -Werror -pthread -I includes \
+		-DFORK_LOCK=FORK_LOCK_$lock bench/fork_lock_bench.c \
+		srcs/fork_lock_mutex.c srcs/fork_lock_ticket.c srcs/fork_lock_mcs.c \
+		-o "$BIN" || exit 1
+	for threads in $THREADS
+	do
+		"$BIN" "$threads" "$HANDOFFS" "$HOLD_US"
+	done
+done
@@ -0,0 +1,173 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   fork_lock_bench.c                                  :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: antestem <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/07/11 16:59:02 by antestem          #+#    #+#             */
+/*   Updated: 2024/07/11 16:59:03 by antestem         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "philosophers.h"
+#include <sys/resource.h>
+#include <time.h>
+
+#if FORK_LOCK == FORK_LOCK_ADAPTIVE
+# define FORK_LOCK_NAME "adaptive"
+#elif FORK_LOCK == FORK_LOCK_TICKET
+# define FORK_LOCK_NAME "ticket"
+#elif FORK_LOCK == FORK_LOCK_MCS
+# define FORK_LOCK_NAME "mcs"
+#else
+# define FORK_LOCK_NAME "mutex"
+#endif
+
+typedef struct s_bench
+{
+	t_fork_lock		lock;
+	long			handoffs;
+	long			hold_us;
+	atomic_long		next_handoff;
+	long			released_at;
+	int				last_holder;
+	long			*latencies;
+}					t_bench;
+
+typedef struct s_contender
+{
+	pthread_t		thread;
+	int				id;
+	t_fork_node		node;
+	t_bench			*bench;
+}	__attribute__((aligned(CACHE_LINE_SIZE)))	t_contender;
+
+/* now_ns:
+ *   Returns the monotonic clock in nanoseconds.
+ */
+static long	now_ns(void)
+{
+	struct timespec	ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec * 1000000000L + ts.tv_nsec);
+}
+
+/* contender_routine:
+ *   Repeatedly takes the shared fork, holds it for hold_us like a
+ *   philosopher eating, and releases it. Whenever the fork changes
+ *   hands, records the time between the release and the new owner
+ *   getting the fork.
+ */
+static void	*contender_routine(void *data)
+{
+	t_contender	*self;
+	t_bench		*bench;
+	long		slot;
+
+	self = data;
+	bench = self->bench;
+	while (true)
+	{
+		fork_lock_acquire(&bench->lock, &self->node);
+		slot = atomic_fetch_add(&bench->next_handoff, 1);
+		if (slot >= bench->handoffs)
+		{
+			fork_lock_release(&bench->lock, &self->node);
+			return (NULL);
+		}
+		bench->latencies[slot] = -1;
+		if (bench->released_at && bench->last_holder != self->id)
+			bench->latencies[slot] = now_ns() - bench->released_at;
+		bench->last_holder = self->id;
+		if (bench->hold_us)
+			usleep(bench->hold_us);
+		bench->released_at = now_ns();
+		fork_lock_release(&bench->lock, &self->node);
+	}
+}
+
+/* compare_longs:
+ *   Orders the handoff latencies for qsort, from the shortest.
+ */
+static int	compare_longs(const void *a, const void *b)
+{
+	return ((*(long *)a > *(long *)b) - (*(long *)a < *(long *)b));
+}
+
+/* report:
+ *   Prints one line of results: the handoff latency percentiles over
+ *   the handoffs where the fork changed hands, and the CPU time spent
+ *   by the process per unit of wall time.
+ */
+static void	report(t_bench *bench, int threads, long wall_ns)
+{
+	struct rusage	usage;
+	long			count;
+	long			i;
+	long			cpu_us;
+
+	getrusage(RUSAGE_SELF, &usage);
+	cpu_us = usage.ru_utime.tv_sec * 1000000L + usage.ru_utime.tv_usec
+		+ usage.ru_stime.tv_sec * 1000000L + usage.ru_stime.tv_usec;
+	count = 0;
+	i = 0;
+	while (i < bench->handoffs)
+	{
+		if (bench->latencies[i] >= 0)
+			bench->latencies[count++] = bench->latencies[i];
+		i++;
+	}
+	qsort(bench->latencies, count, sizeof(long), compare_longs);
+	if (count == 0)
+		bench->latencies[count++] = 0;
+	printf("%-9s %-7d %-8ld %-9ld %-9ld %-10ld %-9ld %.2f %ld\n",
+		FORK_LOCK_NAME, threads, count, bench->latencies[count / 2],
+		bench->latencies[count * 99 / 100], bench->latencies[count - 1],
+		wall_ns / 1000000, (double)cpu_us * 1000 / wall_ns,
+		usage.ru_nvcsw + usage.ru_nivcsw);
+}
+
+/* main:
+ *   usage: fork_lock_bench <threads> <handoffs> <hold_us>
+ *   Makes <threads> threads fight over a single fork built with the
+ *   FORK_LOCK implementation, and reports handoff latency in nanoseconds
+ *   (median, p99, max), CPU time per wall time and context switches.
+ */
+int	main(int argc, char **argv)
+{
+	t_bench		bench;
+	t_contender	*contenders;
+	int			threads;
+	int			i;
+	long		start;
+
+	if (argc != 4)
+		return (printf("usage: %s <threads> <handoffs> <hold_us>\n",
+				argv[0]), EXIT_FAILURE);
+	threads = atoi(argv[1]);
+	memset(&bench, 0, sizeof(t_bench));
+	bench.handoffs = atol(argv[2]);
+	bench.hold_us = atol(argv[3]);
+	bench.last_holder = -1;
+	bench.latencies = malloc(sizeof(long) * bench.handoffs);
+	contenders = aligned_alloc(CACHE_LINE_SIZE, sizeof(t_contender) * threads);
+	if (threads < 1 || !bench.latencies || !contenders
+		|| !fork_lock_init(&bench.lock, false))
+		return (EXIT_FAILURE);
+	start = now_ns();
+	i = -1;
+	while (++i < threads)
+	{
+		contenders[i].id = i;
+		contenders[i].bench = &bench;
+		pthread_create(&contenders[i].thread, NULL, contender_routine,
+			&contenders[i]);
+	}
+	while (i-- > 0)
+		pthread_join(contenders[i].thread, NULL);
+	report(&bench, threads, now_ns() - start);
+	fork_lock_destroy(&bench.lock);
+	return (free(bench.latencies), free(contenders), EXIT_SUCCESS);
+}
@@ -0,0 +1,30 @@
+#!/bin/sh
+# Generates a random topology edge list for ./philo (see PHILO_TOPOLOGY).
+# usage: bench/gen_topology.sh <philosophers> <forks> <max_forks_each> [seed]
+# Every philosopher needs between 2 and <max_forks_each> distinct forks,
+# picked uniformly among <forks>.
+
+if [ $# -lt 3 ]; then
+	echo "usage: $0 <philosophers> <forks> <max_forks_each> [seed]" >&2
+	exit 1
+fi
+
+awk -v n="$1" -v r="$2" -v k="$3" -v seed="${4:-42}" 'BEGIN {
+	srand(seed);
+	if (k > r)
+		k = r;
+	printf("# %d philosophers, %d forks, 2..%d forks each, seed %d\n",
+		n, r, k, seed);
+	for (p = 1; p <= n; p++) {
+		want = 2 + int(rand() * (k - 1));
+		split("", taken);
+		for (got = 0; got < want; ) {
+			f = int(rand() * r);
+			if (!(f in taken)) {
+				taken[f] = 1;
+				printf("%d %d\n", p, f);
+				got++;
+			}
+		}
+	}
+}'
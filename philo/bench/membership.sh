@@ -0,0 +1,33 @@
+#!/bin/sh
+# Measures the meal throughput of a ring whose philosophers join and leave
+# while it runs (PHILO_CHURN_INTERVAL_US), from no churn up to a change
+# every millisecond. Each run is stopped by SIGINT after a fixed duration.
+# A philosopher whose neighbors change may find them eating in turn, so
+# time_to_die leaves room for three meals and a nap rather than two.
+# usage: bench/membership.sh [philosophers] [seconds]
+
+cd "$(dirname "$0")/.." || exit 1
+N="${1:-20}"
+SECONDS_RUN="${2:-4}"
+OUT="$(mktemp)"
+trap 'rm -f "$OUT" "$OUT.err"' EXIT
+
+printf "%-10s %-10s %-7s %-7s %-7s %-9s %s\n" \
+	"interval" "changes/s" "joins" "leaves" "seated" "meals/s" "deaths"
+for interval in 0 500000 100000 20000 5000 1000
+do
+	PHILO_CHURN_INTERVAL_US="$interval" timeout -s INT "$SECONDS_RUN" \
+		./philo "$N" 1200 200 200 > "$OUT" 2> "$OUT.err"
+	set -- $(awk -v n="$N" '
+	$1 == "membership:" { joins = $3; leaves = $5; seated = $7 }
+	END { if (seated == "") seated = n; print joins + 0, leaves + 0, seated }
+	' "$OUT.err")
+	printf "%-10s %-10s %-7s %-7s %-7s " "$interval" \
+		"$(( ($1 + $2) / SECONDS_RUN ))" "$1" "$2" "$3"
+	awk '
+	$3 == "is" && $4 == "eating" { meals++ }
+	$3 == "died" { died++ }
+	$1 ~ /^[0-9]+$/ { span = $1 }
+	END { printf("%-9d %d\n", meals * 1000 / (span > 0 ? span : 1), died) }
+	' "$OUT"
+done
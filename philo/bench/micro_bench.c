@@ -0,0 +1,137 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   micro_bench.c                                      :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: antestem <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/07/11 17:01:04 by antestem          #+#    #+#             */
+/*   Updated: 2024/07/11 17:01:05 by antestem         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "philosophers.h"
+#include <time.h>
+
+/* now_ns:
+ *   Returns the monotonic clock in nanoseconds.
+ */
+static long	now_ns(void)
+{
+	struct timespec	ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec * 1000000000L + ts.tv_nsec);
+}
+
+/* report:
+ *   Prints the JSON object for one micro-benchmark: the mean cost of a
+ *   call and, for sleeps, the mean and worst oversleep.
+ */
+static void	report(char *name, long calls, long total_ns, long max_ns)
+{
+	printf("{\"name\": \"%s\", \"calls\": %ld, \"ns_per_call\": %ld",
+		name, calls, total_ns / calls);
+	if (max_ns >= 0)
+		printf(", \"mean_oversleep_us\": %ld, \"max_oversleep_us\": %ld",
+			total_ns / calls / 1000 - 1000, max_ns / 1000 - 1000);
+	printf("}\n");
+}
+
+/* bench_calls:
+ *   Times the calls every philosopher makes in its loops: reading the
+ *   clock, checking the stop flag, and printing a status line, the last
+ *   one with the standard output sent to /dev/null.
+ */
+static void	bench_calls(t_dining_table *dining_table, long calls)
+{
+	long	i;
+	long	start;
+	int		saved_stdout;
+	int		null_fd;
+
+	start = now_ns();
+	i = -1;
+	while (++i < calls)
+		get_current_time_in_ms();
+	report("get_current_time_in_ms", calls, now_ns() - start, -1);
+	start = now_ns();
+	i = -1;
+	while (++i < calls)
+		is_simulation_stopped(dining_table);
+	report("is_simulation_stopped", calls, now_ns() - start, -1);
+	fflush(stdout);
+	saved_stdout = dup(STDOUT_FILENO);
+	null_fd = open("/dev/null", O_WRONLY);
+	dup2(null_fd, STDOUT_FILENO);
+	start = now_ns();
+	i = -1;
+	while (++i < calls)
+		philo_stat(dining_table->philosophers[0], false, PHILO_THINKING);
+	fflush(stdout);
+	start = now_ns() - start;
+	dup2(saved_stdout, STDOUT_FILENO);
+	close(null_fd);
+	close(saved_stdout);
+	report("philo_stat", calls, start, -1);
+}
+
+/* bench_sleep:
+ *   Times philosopher_sleep for 1 millisecond and reports how much
+ *   longer than asked it sleeps, on average and at worst.
+ */
+static void	bench_sleep(t_dining_table *dining_table, long calls)
+{
+	long	i;
+	long	start;
+	long	elapsed;
+	long	total;
+	long	max;
+
+	total = 0;
+	max = 0;
+	i = -1;
+	while (++i < calls)
+	{
+		start = now_ns();
+		philosopher_sleep(dining_table->philosophers[0], 1);
+		elapsed = now_ns() - start;
+		total += elapsed;
+		if (elapsed > max)
+			max = elapsed;
+	}
+	report("philosopher_sleep", calls, total, max);
+}
+
+/* main:
+ *   usage: micro_bench [calls]
+ *   Builds a dining table from the default settings and PHILO_*
+ *   variables, without starting the simulation, and prints the cost of
+ *   the simulator's most frequent calls, one JSON object per line.
+ */
+int	main(int argc, char **argv)
+{
+	t_dining_table	*dining_table;
+	t_settings		settings;
+	long			calls;
+
+	calls = 1000000;
+	if (argc > 1)
+		calls = atol(argv[1]);
+	init_default_settings(&settings);
+	settings.num_philosophers = 2;
+	settings.time_to_die = 1000;
+	settings.time_to_eat = 100;
+	settings.time_to_sleep = 100;
+	if (calls < 1 || !load_settings(&settings, 1, argv))
+		return (free_settings(&settings), EXIT_FAILURE);
+	dining_table = init_dining_table(&settings);
+	if (!dining_table)
+		return (EXIT_FAILURE);
+	dining_table->start_time = get_current_time_in_ms();
+	bench_calls(dining_table, calls);
+	bench_sleep(dining_table, calls / 1000 + 1);
+	destroy_all_mutexes(dining_table);
+	free_dining_table(dining_table);
+	return (EXIT_SUCCESS);
+}
@@ -0,0 +1,19 @@
+#!/bin/sh
+# Measures the "merged" writer's throughput with each output_io backend,
+# the standard output being a file and then a pipe: events written and
+# write syscalls made per second, one JSON object per line.
+# usage: bench/output.sh [philosophers] [thousands_of_events_each]
+
+cd "$(dirname "$0")/.." || exit 1
+OUT="$(mktemp)"
+trap 'rm -f "$OUT"' EXIT
+
+for io in writev write
+do
+	printf '{"stdout": "file", "result": '
+	PHILO_OUTPUT_IO="$io" bench/output_bench "$@" 2>&1 > "$OUT" | tr -d '\n'
+	printf '}\n{"stdout": "pipe", "result": '
+	{ PHILO_OUTPUT_IO="$io" bench/output_bench "$@" 2>&3 | cat > /dev/null; } \
+		3>&1 | tr -d '\n'
+	printf '}\n'
+done
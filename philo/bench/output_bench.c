@@ -0,0 +1,113 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   output_bench.c                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: antestem <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/07/11 17:01:18 by antestem          #+#    #+#             */
+/*   Updated: 2024/07/11 17:01:19 by antestem         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "philosophers.h"
+#include <time.h>
+
+/* now_ns:
+ *   Returns the monotonic clock in nanoseconds.
+ */
+static long	now_ns(void)
+{
+	struct timespec	ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec * 1000000000L + ts.tv_nsec);
+}
+
+/* producer_routine:
+ *   Pushes status events for one philosopher as fast as its ring lets
+ *   it, cycling through the statuses a philosopher goes through.
+ */
+static void	*producer_routine(void *data)
+{
+	t_philosopher	*philosopher;
+	long			i;
+
+	philosopher = (t_philosopher *)data;
+	philosopher->forks_held = 1;
+	i = -1;
+	while (++i < philosopher->dining_table->settings.must_eat_count * 1000L)
+		push_output_event(philosopher, PHILO_EATING + i % PHILO_GOT_FORK);
+	return (NULL);
+}
+
+/* run_bench:
+ *   Starts the output thread and one producer per philosopher, waits
+ *   until every event was written, and prints the events and syscalls
+ *   per second to the standard error, the standard output being the
+ *   one measured.
+ */
+static void	run_bench(t_dining_table *dining_table)
+{
+	pthread_t		output_thread;
+	unsigned int	i;
+	long			start;
+
+	start = now_ns();
+	pthread_create(&output_thread, NULL, &output_routine, dining_table);
+	i = -1;
+	while (++i < dining_table->num_philosophers)
+		pthread_create(&dining_table->philosophers[i]->thread, NULL,
+			&producer_routine, dining_table->philosophers[i]);
+	i = -1;
+	while (++i < dining_table->num_philosophers)
+		pthread_join(dining_table->philosophers[i]->thread, NULL);
+	atomic_store(&dining_table->output.finish, true);
+	pthread_join(output_thread, NULL);
+	start = now_ns() - start;
+	fprintf(stderr, "{\"output_io\": \"%s\", \"events\": %lu, "
+		"\"syscalls\": %lu, \"dropped_bytes\": %lu, \"events_per_s\": %ld, "
+		"\"syscalls_per_s\": %ld}\n",
+		(char *[]){"writev", "write"}[dining_table->settings.output_io],
+		dining_table->output.events, dining_table->output.syscalls,
+		dining_table->output.dropped_bytes,
+		(long)(dining_table->output.events * 1000000000.0 / start),
+		(long)(dining_table->output.syscalls * 1000000000.0 / start));
+}
+
+/* main:
+ *   usage: output_bench [philosophers] [thousands_of_events_each]
+ *   Measures the "merged" writer on its own: producers push events into
+ *   the output rings without simulating anything, and the output and
+ *   writer threads format and write them to the standard output.
+ *   PHILO_OUTPUT_IO and PHILO_FLUSH_INTERVAL_US apply.
+ */
+int	main(int argc, char **argv)
+{
+	t_dining_table	*dining_table;
+	t_settings		settings;
+
+	init_default_settings(&settings);
+	settings.num_philosophers = 4;
+	settings.time_to_die = 1000;
+	settings.time_to_eat = 100;
+	settings.time_to_sleep = 100;
+	settings.must_eat_count = 200;
+	if (!load_settings(&settings, 1, argv))
+		return (free_settings(&settings), EXIT_FAILURE);
+	if (argc > 1)
+		settings.num_philosophers = atol(argv[1]);
+	if (argc > 2)
+		settings.must_eat_count = atol(argv[2]);
+	settings.writer = WRITER_MERGED;
+	if (settings.num_philosophers < 1 || settings.must_eat_count < 1)
+		return (free_settings(&settings), EXIT_FAILURE);
+	dining_table = init_dining_table(&settings);
+	if (!dining_table)
+		return (EXIT_FAILURE);
+	dining_table->start_time = get_current_time_in_ms();
+	run_bench(dining_table);
+	destroy_all_mutexes(dining_table);
+	free_dining_table(dining_table);
+	return (EXIT_SUCCESS);
+}
@@ -0,0 +1,42 @@
+#!/bin/sh
+# Compares the thread mode with worker processes (PHILO_PROCESSES): one
+# process per shard of philosophers, then one per philosopher. Prints one
+# JSON object per run and line with the CPU time spent per printed event
+# and the context switches, on an output-heavy scenario. Needs
+# bench/rusage, which "make bench" builds.
+# usage: bench/processes.sh [philosophers] [runs]
+
+cd "$(dirname "$0")/.." || exit 1
+N="${1:-20}"
+RUNS="${2:-1}"
+OUT="$(mktemp)"
+trap 'rm -f "$OUT"' EXIT
+
+for processes in 0 2 "$N"
+do
+	for writer in locked merged
+	do
+		run=0
+		while [ "$run" -lt "$RUNS" ]
+		do
+			set -- $(PHILO_PROCESSES="$processes" PHILO_WRITER="$writer" \
+				bench/rusage "$OUT" ./philo "$N" 200 10 10 50)
+			awk -v processes="$processes" -v writer="$writer" -v run="$run" \
+				-v status="$1" -v wall="$2" -v cpu="$(($3 + $4))" \
+				-v vcsw="$5" -v ivcsw="$6" -v events="$(wc -l < "$OUT")" \
+				'BEGIN {
+				printf("{\"processes\": %d, \"writer\": \"%s\", \"run\": %d, ",
+					processes, writer, run);
+				printf("\"exit_status\": %d, \"wall_ms\": %.1f, ", status,
+					wall / 1000);
+				printf("\"cpu_ms\": %.1f, \"events\": %d, ", cpu / 1000,
+					events);
+				printf("\"cpu_ns_per_event\": %d, ",
+					cpu * 1000 / (events > 0 ? events : 1));
+				printf("\"voluntary_ctxsw\": %d, \"involuntary_ctxsw\": %d}\n",
+					vcsw, ivcsw);
+				}'
+			run=$((run + 1))
+		done
+	done
+done
@@ -0,0 +1,52 @@
+#!/bin/sh
+# Measures what the real-time mode (PHILO_REALTIME=fifo) buys on a busy
+# host: while busy loops, two per core by default, compete for the CPU,
+# a tight table that should survive is run a number of times with and
+# without it, and so is a table that must die, to see how late its death
+# is printed (see check_log.sh). SCHED_FIFO needs root, CAP_SYS_NICE or
+# RLIMIT_RTPRIO; without them the fifo runs warn and fall back to the
+# normal policy.
+# usage: bench/realtime.sh [runs] [busy loops per core]
+
+cd "$(dirname "$0")/.." || exit 1
+RUNS="${1:-10}"
+HOGS_PER_CORE="${2:-2}"
+OUT="$(mktemp)"
+HOGS=""
+trap 'kill $HOGS 2> /dev/null; rm -f "$OUT"' EXIT
+
+i=0
+while [ "$i" -lt $(( $(nproc) * HOGS_PER_CORE )) ]
+do
+	sh -c 'while :; do :; done' &
+	HOGS="$HOGS $!"
+	i=$(( i + 1 ))
+done
+printf "%-9s %-6s %-10s %-17s %s\n" "realtime" "runs" "survival" \
+	"death_latency_ms" "worst_ms"
+for mode in off fifo
+do
+	survived=0
+	latency=0
+	worst=0
+	i=0
+	while [ "$i" -lt "$RUNS" ]
+	do
+		PHILO_REALTIME="$mode" timeout -s INT 30 ./philo 4 410 200 200 10 \
+			> "$OUT" 2> /dev/null
+		grep -q " died$" "$OUT" || survived=$(( survived + 1 ))
+		PHILO_REALTIME="$mode" timeout -s INT 30 ./philo 4 310 200 100 \
+			> "$OUT" 2> /dev/null
+		late="$(sh bench/check_log.sh 4 310 -1 "$OUT" \
+			| sed -n 's/.*latency_ms=\([0-9]*\).*/\1/p')"
+		late="${late:-0}"
+		latency=$(( latency + late ))
+		[ "$late" -gt "$worst" ] && worst="$late"
+		i=$(( i + 1 ))
+	done
+	printf "%-9s %-6d %-10s %-17s %d\n" "$mode" "$RUNS" \
+		"$(( survived * 100 / RUNS ))%" \
+		"$(awk -v t="$latency" -v n="$RUNS" \
+			'BEGIN { printf("%.1f", t / n) }')" \
+		"$worst"
+done
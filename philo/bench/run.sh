@@ -0,0 +1,30 @@
+#!/bin/sh
+# Runs the benchmark suite, the simulation scenarios, the micro-benchmarks
+# and the output benchmark, and writes the results as one JSON document so
+# they can be compared from run to run (see compare.sh). Called by "make
+# bench".
+# usage: bench/run.sh [output] [runs]
+
+cd "$(dirname "$0")/.." || exit 1
+OUTPUT="${1:-bench_results.json}"
+RUNS="${2:-1}"
+
+# Indents JSON lines into the body of an array.
+as_array() {
+	sed 's/^/    /; $!s/$/,/'
+}
+
+{
+	printf '{\n  "date": "%s",\n' "$(date -u +%Y-%m-%dT%H:%M:%SZ)"
+	printf '  "commit": "%s",\n' "$(git rev-parse --short HEAD 2>/dev/null)"
+	printf '  "cpus": %d,\n  "fork_lock": "%s",\n' "$(nproc)" \
+		"${FORK_LOCK:-mutex}"
+	printf '  "scenarios": [\n'
+	bench/scenarios.sh "$RUNS" | as_array
+	printf '  ],\n  "micro": [\n'
+	bench/micro_bench | as_array
+	printf '  ],\n  "output": [\n'
+	bench/output.sh | as_array
+	printf '  ]\n}\n'
+} > "$OUTPUT" || exit 1
+cat "$OUTPUT"
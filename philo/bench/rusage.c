@@ -0,0 +1,77 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   rusage.c                                           :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: antestem <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/07/11 17:01:02 by antestem          #+#    #+#             */
+/*   Updated: 2024/07/11 17:01:03 by antestem         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+/* now_us:
+ *   Returns the monotonic clock in microseconds.
+ */
+static long	now_us(void)
+{
+	struct timespec	ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec * 1000000L + ts.tv_nsec / 1000);
+}
+
+/* run_child:
+ *   Runs the command with its standard output sent to the output file.
+ */
+static void	run_child(char *output, char **command)
+{
+	int	fd;
+
+	fd = open(output, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0 || dup2(fd, STDOUT_FILENO) < 0)
+		exit(127);
+	close(fd);
+	execv(command[0], command);
+	exit(127);
+}
+
+/* main:
+ *   usage: rusage <output> <program> [arguments...]
+ *   Runs a program with its standard output sent to <output>, then
+ *   prints what it cost, in the order the bench scripts read it:
+ *   "<exit status> <wall_us> <user_us> <sys_us> <voluntary context
+ *   switches> <involuntary context switches>".
+ */
+int	main(int argc, char **argv)
+{
+	struct rusage	usage;
+	pid_t			pid;
+	int				status;
+	long			start;
+
+	if (argc < 3)
+		return (fprintf(stderr, "usage: %s <output> <program> [args...]\n",
+				argv[0]), EXIT_FAILURE);
+	start = now_us();
+	pid = fork();
+	if (pid < 0)
+		return (EXIT_FAILURE);
+	if (pid == 0)
+		run_child(argv[1], argv + 2);
+	if (wait4(pid, &status, 0, &usage) < 0)
+		return (EXIT_FAILURE);
+	printf("%d %ld %ld %ld %ld %ld\n", WEXITSTATUS(status), now_us() - start,
+		usage.ru_utime.tv_sec * 1000000L + usage.ru_utime.tv_usec,
+		usage.ru_stime.tv_sec * 1000000L + usage.ru_stime.tv_usec,
+		usage.ru_nvcsw, usage.ru_nivcsw);
+	return (EXIT_SUCCESS);
+}
@@ -0,0 +1,60 @@
+#!/bin/sh
+# Runs ./philo on the reproducible benchmark scenarios and prints one JSON
+# object per run and line: wall and CPU time, meals per simulated second,
+# deaths, death-detection latency (how long after time_to_die without a
+# meal the death was printed) and context switches. Needs bench/rusage,
+# which "make bench" builds.
+# usage: bench/scenarios.sh [runs]
+
+cd "$(dirname "$0")/.." || exit 1
+RUNS="${1:-1}"
+OUT="$(mktemp)"
+trap 'rm -f "$OUT"' EXIT
+
+# "<name> <arguments>": tight survival, high N, output-heavy short cycles,
+# and a certain death to measure detection latency.
+SCENARIOS="tight 4 410 200 200 20
+crowded 250 800 200 200 5
+chatty 20 200 10 10 100
+death 4 310 200 100 5"
+
+# Prints "<meals> <last timestamp> <deaths> <death latency or -1>" for a
+# log.
+summarize() {
+	awk -v die="$1" '
+	$3 == "is" && $4 == "eating" { meals++; last[$2] = $1 }
+	$3 == "died" && !died++ { latency = $1 - last[$2] - die }
+	{ end = $1 }
+	END { printf("%d %d %d %d\n", meals, end, died, died ? latency : -1) }' "$2"
+}
+
+echo "$SCENARIOS" | while read -r name args
+do
+	run=0
+	while [ "$run" -lt "$RUNS" ]
+	do
+		set -- $(bench/rusage "$OUT" ./philo $args)
+		status=$1; wall=$2; user=$3; sys=$4; vcsw=$5; ivcsw=$6
+		set -- $args
+		set -- $(summarize "$2" "$OUT")
+		awk -v name="$name" -v args="$args" -v run="$run" -v status="$status" \
+			-v wall="$wall" -v user="$user" -v sys="$sys" -v meals="$1" \
+			-v span="$2" -v deaths="$3" -v latency="$4" \
+			-v vcsw="$vcsw" -v ivcsw="$ivcsw" \
+			'BEGIN {
+			printf("{\"name\": \"%s\", \"args\": \"%s\", \"run\": %d, ",
+				name, args, run);
+			printf("\"exit_status\": %d, \"wall_ms\": %.1f, ", status,
+				wall / 1000);
+			printf("\"user_ms\": %.1f, \"sys_ms\": %.1f, \"cpu_ms\": %.1f, ",
+				user / 1000, sys / 1000, (user + sys) / 1000);
+			printf("\"meals\": %d, \"meals_per_sec\": %.1f, ", meals,
+				meals * 1000 / (span > 0 ? span : 1));
+			printf("\"deaths\": %d, \"death_latency_ms\": %s, ", deaths,
+				latency < 0 ? "null" : latency);
+			printf("\"voluntary_ctxsw\": %d, \"involuntary_ctxsw\": %d}\n",
+				vcsw, ivcsw);
+			}'
+		run=$((run + 1))
+	done
+done
@@ -0,0 +1,71 @@
+#!/bin/sh
+# Runs a stress build of ./philo (STRESS=1 in the Makefile) on a set of
+# scenarios, once per seed, with pseudo-random delays injected at every lock
+# and sleep point and busy processes competing for the CPUs, then checks
+# each output with bench/check_log.sh. A seed fixes the sequence of delays
+# of every thread; every run is also recorded with PHILO_RECORD, and the
+# output and trace of a failing run are kept in stress_failures/ so that
+# its interleaving can be replayed with PHILO_REPLAY.
+# usage: bench/stress.sh [seeds] [noise_max_us] [busy_processes]
+
+cd "$(dirname "$0")/.." || exit 1
+SEEDS="${1:-20}"
+NOISE="${2:-500}"
+BUSY="${3:-$(nproc)}"
+LOCK="$(echo "${FORK_LOCK:-mutex}" | tr 'a-z' 'A-Z')"
+BIN="$(mktemp)"
+TMP="$(mktemp -d)"
+FAILED_DIR="stress_failures"
+PIDS=""
+trap '[ -n "$PIDS" ] && kill $PIDS 2>/dev/null; rm -rf "$BIN" "$TMP"' EXIT
+
+# "<name> <arguments>": survival, odd and even tables, two and one
+# philosophers, a certain death and a bigger table.
+SCENARIOS="five 5 800 200 200 7
+tight 4 410 200 200 10
+odd 3 610 200 200 10
+pair 2 410 200 200 10
+death 4 310 200 100 5
+alone 1 800 200 200
+crowd 31 800 200 200 4"
+
+gcc -O2 -Wall -Wextra -Werror -pthread -I includes -DSTRESS_NOISE=1 \
+	-DFORK_LOCK=FORK_LOCK_"$LOCK" srcs/*.c -o "$BIN" || exit 1
+i=0
+while [ "$i" -lt "$BUSY" ]
+do
+	sh -c 'while :; do :; done' &
+	PIDS="$PIDS $!"
+	i=$((i + 1))
+done
+
+echo "# fork lock $LOCK, noise up to ${NOISE}us, $BUSY busy processes"
+runs=0
+failures=0
+seed=1
+while [ "$seed" -le "$SEEDS" ]
+do
+	echo "$SCENARIOS" > "$TMP/scenarios"
+	while read -r name args
+	do
+		set -- $args
+		PHILO_NOISE_SEED="$seed" PHILO_NOISE_MAX_US="$NOISE" \
+			PHILO_RECORD="$TMP/trace" timeout 120 "$BIN" $args > "$TMP/out"
+		status=$?
+		result="$(bench/check_log.sh "$1" "$2" "${5:--1}" "$TMP/out")"
+		if [ $? -ne 0 ] || [ "$status" -ne 0 ]; then
+			failures=$((failures + 1))
+			mkdir -p "$FAILED_DIR"
+			cp "$TMP/out" "$FAILED_DIR/$name-$seed.out"
+			cp "$TMP/trace" "$FAILED_DIR/$name-$seed.trace" 2>/dev/null
+			echo "FAIL seed $seed $name ($args), exit status $status"
+			echo "$result" | sed 's/^/  /'
+		else
+			echo "ok   seed $seed $name: $(echo "$result" | tail -n 1)"
+		fi
+		runs=$((runs + 1))
+	done < "$TMP/scenarios"
+	seed=$((seed + 1))
+done
+echo "# $runs runs, $failures failed"
+[ "$failures" -eq 0 ]
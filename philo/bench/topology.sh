@@ -0,0 +1,36 @@
+#!/bin/sh
+# Runs ./philo on large random topologies and reports how long loading and
+# coloring the graph takes, then the meal throughput of a short simulation.
+# usage: bench/topology.sh [time_to_die] [time_to_eat] [time_to_sleep]
+
+cd "$(dirname "$0")/.." || exit 1
+DIE="${1:-2000}"
+EAT="${2:-20}"
+SLEEP="${3:-20}"
+MEALS=5
+TMP="$(mktemp)"
+trap 'rm -f "$TMP" "$TMP.out"' EXIT
+
+now_ms() {
+	date +%s%N | cut -b1-13
+}
+
+printf "%-6s %-6s %-4s %-8s %-10s %-10s %s\n" \
+	"philos" "forks" "k" "edges" "init_ms" "meals/s" "died"
+for graph in "50 50 2" "250 250 3" "250 1000 4" "250 5000 8" "250 65536 16"
+do
+	set -- $graph
+	bench/gen_topology.sh "$1" "$2" "$3" 42 > "$TMP"
+	edges=$(grep -vc '^#' "$TMP")
+	start=$(now_ms)
+	PHILO_TOPOLOGY="$TMP" ./philo "$1" "$DIE" "$EAT" "$SLEEP" 0 > /dev/null
+	init=$(( $(now_ms) - start ))
+	start=$(now_ms)
+	PHILO_TOPOLOGY="$TMP" ./philo "$1" "$DIE" "$EAT" "$SLEEP" "$MEALS" \
+		> "$TMP.out"
+	wall=$(( $(now_ms) - start - $1 * 20 ))
+	meals=$(grep -c "is eating" "$TMP.out")
+	died=$(grep -c "died" "$TMP.out")
+	printf "%-6s %-6s %-4s %-8s %-10s %-10s %s\n" "$1" "$2" "$3" "$edges" \
+		"$init" "$(( meals * 1000 / (wall > 0 ? wall : 1) ))" "$died"
+done
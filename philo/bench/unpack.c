@@ -0,0 +1,86 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   unpack.c                                           :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: antestem <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/07/11 17:02:00 by antestem          #+#    #+#             */
+/*   Updated: 2024/07/11 17:02:01 by antestem         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "philosophers.h"
+
+/* read_exactly:
+ *   Reads a number of bytes from the standard input.
+ *
+ *   Returns:
+ *     - A boolean indicating whether they were all read.
+ */
+static bool	read_exactly(unsigned char *buffer, size_t length)
+{
+	return (fread(buffer, 1, length, stdin) == length);
+}
+
+/* unpack_blocks:
+ *   Decodes the blocks of a "compressed" output up to its empty last
+ *   block, printing their events to the standard output.
+ *
+ *   Returns:
+ *     - A boolean indicating whether every block was valid.
+ */
+static bool	unpack_blocks(t_output_codec *codec, unsigned char *block)
+{
+	uint32_t	compressed;
+
+	while (read_exactly(block, CODEC_HEADER_SIZE))
+	{
+		compressed = block[4] | block[5] << 8 | block[6] << 16
+			| (uint32_t)block[7] << 24;
+		if (compressed == 0)
+			return (true);
+		if (compressed > OUTPUT_BUFFER_SIZE - CODEC_HEADER_SIZE
+			|| !read_exactly(block + CODEC_HEADER_SIZE, compressed)
+			|| !decode_output_block(codec, block, stdout))
+			return (false);
+	}
+	return (false);
+}
+
+/* main:
+ *   Turns the "compressed" output of philo, on the standard input, back
+ *   into the exact text the plain output would have printed, including
+ *   whatever was printed after the stream:
+ *     PHILO_WRITER=merged PHILO_OUTPUT=compressed ./philo 5 800 200 200
+ *       | bench/unpack
+ *
+ *   Returns:
+ *     - EXIT_SUCCESS, or EXIT_FAILURE if the stream is damaged or cut.
+ */
+int	main(void)
+{
+	t_output_codec	codec;
+	unsigned char	*block;
+	size_t			length;
+	bool			valid;
+
+	memset(&codec, 0, sizeof(t_output_codec));
+	codec.block = malloc(CODEC_BLOCK_SIZE);
+	block = malloc(OUTPUT_BUFFER_SIZE);
+	valid = codec.block && block && read_exactly(block, 4)
+		&& (block[0] | block[1] << 8 | block[2] << 16
+			| (uint32_t)block[3] << 24) == CODEC_MAGIC
+		&& unpack_blocks(&codec, block);
+	length = 1;
+	while (valid && length > 0)
+	{
+		length = fread(block, 1, OUTPUT_BUFFER_SIZE, stdin);
+		fwrite(block, 1, length, stdout);
+	}
+	free(codec.block);
+	free(block);
+	if (!valid)
+		fprintf(stderr, "unpack: not a complete compressed output\n");
+	return (!valid);
+}
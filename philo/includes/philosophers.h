@@ -13,48 +13,698 @@
 #ifndef PHILOSOPHERS_H
 # define PHILOSOPHERS_H
 
+# ifndef _GNU_SOURCE
+#  define _GNU_SOURCE
+# endif
+
+# include <ctype.h>
+# include <errno.h>
+# include <fcntl.h>
 # include <limits.h>
 # include <pthread.h>
+# include <sched.h>
+# include <signal.h>
+# include <stdatomic.h>
 # include <stdbool.h>
+# include <stddef.h>
+# include <stdint.h>
 # include <stdio.h>
 # include <stdlib.h>
+# include <string.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
 # include <sys/time.h>
+# include <sys/uio.h>
 # include <unistd.h>
 
 /* Macros */
 
 # define MAX_PHILOSOPHERS 250
-# define STR_MAX_PHILOSOPHERS "250"
+# define PHILOSOPHERS_LIMIT 65535
+# define MAX_FORKS 65536
+# define STR_MAX_FORKS "65536"
+# define SLEEP_GRANULARITY_US 100
+# define REAPER_INTERVAL_US 1000
+# define REAPER_MIN_INTERVAL_US 100
+# define CALIBRATION_MS 250
+# define CALIBRATION_BUCKETS 20000
+# define CALIBRATION_MAX_SPIN_US 2000
+# define REALTIME_LEVELS 8
+# define SHARED_ARENA_SIZE 1073741824UL
+# define LOW_ARENA_BASE_SIZE 16777216UL
+# define LOW_ARENA_PHILOSOPHER_SIZE 65536UL
+# define STACK_SIZE_KB 64
+# define MEMBERSHIP_READERS 2
+# define NO_SEAT UINT_MAX
+
+# define SETTING_ENV_PREFIX "PHILO_"
+# define CONFIG_ENV "PHILO_CONFIG"
+# define PRESET_ENV "PHILO_PRESET"
+
+# define OUTPUT_CHOICES "plain,debug,compressed"
+# define ACQUISITION_CHOICES "blocking,backoff"
+# define PINNING_CHOICES "none,cores"
+# define WRITER_CHOICES "locked,merged"
+# define OUTPUT_IO_CHOICES "writev,write"
+# define PROFILE_CHOICES "off,states,memory,classes"
+# define ORACLE_CHOICES "off,plan,compare"
+# define SCHEDULE_CHOICES "dynamic,static"
+# define FOOTPRINT_CHOICES "default,low"
+# define REALTIME_CHOICES "off,fifo"
+
+# define OUTPUT_RING_SIZE 1024
+# define OUTPUT_BUFFER_SIZE 16384
+# define OUTPUT_BUFFERS 8
+# define OUTPUT_LINE_MAX 96
+# define OUTPUT_FLUSH_US 1000
+# define OUTPUT_IDLE 0
+# define OUTPUT_BUSY 1
+# define CODEC_MAGIC 0x315a4c50
+# define CODEC_BLOCK_SIZE 16128
+# define CODEC_HEADER_SIZE 8
+# define CODEC_EVENT_MAX 16
+# define CODEC_HASH_BITS 12
+# define CODEC_MIN_MATCH 4
+# define CODEC_SAME_PHILOSOPHER 8
+# define CODEC_DELTA_ESCAPE 15
+# define CODEC_SEAL_MS 1000
+
+# define TRACE_MAGIC 0x54524850
+# define TRACE_VERSION 1
+# define TRACE_CAPACITY 16777216
+# define TRACE_REPLAY_POLL_US 20
+
+# define CHECKPOINT_MAGIC 0x4b434850
+# define CHECKPOINT_VERSION 1
+# define CHECKPOINT_SLOTS 2
+# define CHECKPOINT_EMPTY UINT32_MAX
+# define CHECKPOINT_INTERVAL_MS 1000
+
+# define TIMING_CLASS_FIELDS 6
+
+# define BACKOFF_MIN_US 50
+# define BACKOFF_EAT_DIVISOR 4
 
 # ifndef DEBUG_FORMATTING
 #  define DEBUG_FORMATTING 0
 # endif
 
+/* Stress builds (make STRESS=1) inject pseudo-random delays at every
+ * lock and sleep point, following the noise_seed and noise_max_us
+ * settings. In normal builds the noise points compile to nothing. */
+# ifndef STRESS_NOISE
+#  define STRESS_NOISE 0
+# endif
+# if STRESS_NOISE
+#  define NOISE_POINT(table, seed) noise_point(table, seed)
+# else
+#  define NOISE_POINT(table, seed) (void)0
+# endif
+# define NOISE_SEED_MIX 2654435761u
+
+/* Probe builds (make PROBES=1) fire a probe at every state transition
+ * counted by the "states" profile, for perf or bpftrace to attach to:
+ * a USDT probe philo:transition when <sys/sdt.h> is available, and the
+ * profile_probe function otherwise. In normal builds they compile to
+ * nothing. */
+# ifndef PHILO_PROBES
+#  define PHILO_PROBES 0
+# endif
+# if PHILO_PROBES && defined(__has_include)
+#  if __has_include(<sys/sdt.h>)
+#   include <sys/sdt.h>
+#   define PROBE_TRANSITION(id, state) STAP_PROBE2(philo, transition, id, state)
+#  endif
+# endif
+# ifndef PROBE_TRANSITION
+#  if PHILO_PROBES
+#   define PROBE_TRANSITION(id, state) profile_probe(id, state)
+#  else
+#   define PROBE_TRANSITION(id, state) (void)0
+#  endif
+# endif
+
+/* Fixed builds (make FIXED="<philosophers> <time_to_die> <time_to_eat>
+ * <time_to_sleep> [must_eat]") replace the table's and the philosophers'
+ * parameters with constants in the hot paths, so that the compiler can
+ * drop the branches and bound the loops that depend on them. Such a
+ * build refuses to run with any other parameters or with a timings
+ * file. */
+# ifdef FIXED_PHILOSOPHERS
+#  define TABLE_PHILOSOPHERS(table) ((unsigned int)FIXED_PHILOSOPHERS)
+#  define TABLE_MUST_EAT(table) ((int)FIXED_MUST_EAT)
+#  define PHILO_TIME_TO_DIE(philosopher) ((time_t)FIXED_TIME_TO_DIE)
+#  define PHILO_TIME_TO_EAT(philosopher) ((time_t)FIXED_TIME_TO_EAT)
+#  define PHILO_TIME_TO_SLEEP(philosopher) ((time_t)FIXED_TIME_TO_SLEEP)
+# else
+#  define TABLE_PHILOSOPHERS(table) ((table)->num_philosophers)
+#  define TABLE_MUST_EAT(table) ((table)->must_eat_count)
+#  define PHILO_TIME_TO_DIE(philosopher) ((philosopher)->time_to_die)
+#  define PHILO_TIME_TO_EAT(philosopher) ((philosopher)->time_to_eat)
+#  define PHILO_TIME_TO_SLEEP(philosopher) ((philosopher)->time_to_sleep)
+# endif
+
+# define FORK_LOCK_MUTEX 0
+# define FORK_LOCK_ADAPTIVE 1
+# define FORK_LOCK_TICKET 2
+# define FORK_LOCK_MCS 3
+
+# ifndef FORK_LOCK
+#  define FORK_LOCK FORK_LOCK_MUTEX
+# endif
+
+# define CACHE_LINE_SIZE 64
+# define SPIN_LIMIT 1000
+
+# if defined(__x86_64__) || defined(__i386__)
+#  define CPU_RELAX() __builtin_ia32_pause()
+# elif defined(__aarch64__)
+#  define CPU_RELAX() __asm__ __volatile__ ("yield")
+# else
+#  define CPU_RELAX() atomic_signal_fence(memory_order_seq_cst)
+# endif
+
 # define COLOR_RESET "\e[0m"
 # define COLOR_RED "\e[31m"
 # define COLOR_GREEN "\e[32m"
 # define COLOR_PURPLE "\e[35m"
 # define COLOR_CYAN "\e[36m"
 
+# define STATUS_FORMAT "%ld %d %s\n"
+# define STATUS_DEBUG_FORMAT "[%10ld]\t%s%03d\t%s\e[0m\n"
+# define FORK_DEBUG_FORMAT "[%10ld]\t%s%03d\t%s\e[0m: fork [%d]\n"
+
 # define PROGRAM_NAME "philosophers:"
 # define USAGE_MESSAGE \
 	"%s usage: ./philo <number_of_philosophers> \
 <time_to_die> <time_to_eat> <time_to_sleep> \
-[number_of_times_each_philosopher_must_eat]\n"
+[number_of_times_each_philosopher_must_eat]\n\
+The arguments can be omitted if PHILO_CONFIG, PHILO_PRESET or \
+PHILO_* variables provide them.\n"
 # define ERROR_INVALID_INPUT_DIGIT \
 	"%s invalid input: %s: \
 not a valid unsigned integer between 0 and 2147483647.\n"
 # define ERROR_INVALID_INPUT_RANGE \
 	"%s invalid input: \
 there must be between 1 and %s philosophers.\n"
+# define ERROR_CONFIG_FILE "%s error: Could not read config file %s.\n"
+# define ERROR_CONFIG_LINE "%s invalid config line: %s.\n"
+# define ERROR_UNKNOWN_SETTING "%s unknown setting: %s.\n"
+# define ERROR_INVALID_SETTING "%s invalid value for setting %s.\n"
+# define ERROR_UNKNOWN_PRESET "%s unknown preset: %s.\n"
 # define ERROR_THREAD_CREATION "%s error: Could not create thread.\n"
+# define ERROR_PROCESS_CREATION "%s error: Could not create process.\n"
+# define ERROR_SIGNAL_WATCHER "%s error: Could not watch signals.\n"
 # define ERROR_MEMORY_ALLOCATION "%s error: Could not allocate memory.\n"
 # define ERROR_MUTEX_CREATION "%s error: Could not create mutex.\n"
+# define ERROR_TOPOLOGY_FILE "%s error: Could not read topology file %s.\n"
+# define ERROR_TOPOLOGY_FORMAT "%s invalid topology: %s.\n"
+# define ERROR_TIMINGS_FILE "%s error: Could not read timings file %s.\n"
+# define ERROR_TIMINGS_FORMAT "%s invalid timings: %s.\n"
+# define ERROR_TRACE_FILE "%s error: Could not open trace file %s.\n"
+# define ERROR_TRACE_MISMATCH \
+	"%s error: trace file %s was recorded with other parameters.\n"
+# define ERROR_TRACE_MODE "%s error: cannot record and replay at once.\n"
+# define ERROR_FIXED_BUILD "%s error: this build only runs %s.\n"
+# define ERROR_MEMBERSHIP \
+	"%s error: membership churn needs at least two philosophers on the \
+default ring of forks, in threads, with the locked writer, the dynamic \
+schedule and neither trace nor oracle.\n"
+# define ERROR_STATIC_SCHEDULE \
+	"%s error: the static schedule needs the default ring of forks \
+and the same timings for everyone.\n"
+# define ERROR_CHECKPOINT_FILE \
+	"%s error: Could not open checkpoint file %s.\n"
+# define ERROR_CHECKPOINT_MISMATCH \
+	"%s error: checkpoint file %s was taken with other parameters.\n"
+# define ERROR_CHECKPOINT_EMPTY \
+	"%s error: checkpoint file %s holds no complete checkpoint.\n"
+# define ERROR_CHECKPOINT_MODE \
+	"%s error: checkpoints cannot be taken with membership churn, nor \
+resumed with the static schedule or a replayed trace.\n"
+# define ERROR_CALIBRATION_FILE \
+	"%s error: Could not write calibration file %s.\n"
+# define ERROR_COMPRESSED_OUTPUT \
+	"%s error: the compressed output needs the merged writer.\n"
+# define WARNING_TRACE_FULL \
+	"%s warning: trace file %s is full, later events were not recorded.\n"
+# define WARNING_REALTIME \
+	"%s warning: real-time scheduling is not permitted (%s), running \
+without it.\n"
+# define WARNING_SIGNAL_STOP "%s warning: stopped by signal %s.\n"
+# define WARNING_OUTPUT_DROPPED \
+	"%s warning: %lu bytes of output could not be written.\n"
+# define WARNING_TRACE_DIVERGED \
+	"%s warning: replay left trace file %s, running freely.\n"
 
 /* Structures */
 
 typedef struct s_philosopher	t_philosopher;
 
+# if FORK_LOCK == FORK_LOCK_TICKET
+
+typedef struct s_fork_node
+{
+	char						unused;
+}								t_fork_node;
+
+typedef struct s_fork_lock
+{
+	atomic_uint					next_ticket;
+	atomic_uint					now_serving;
+}	__attribute__((aligned(CACHE_LINE_SIZE)))	t_fork_lock;
+
+# elif FORK_LOCK == FORK_LOCK_MCS
+
+typedef struct s_fork_node
+{
+	struct s_fork_node *_Atomic	next;
+	atomic_bool					waiting;
+}	__attribute__((aligned(CACHE_LINE_SIZE)))	t_fork_node;
+
+typedef struct s_fork_lock
+{
+	t_fork_node *_Atomic		tail;
+}	__attribute__((aligned(CACHE_LINE_SIZE)))	t_fork_lock;
+
+# else
+
+typedef struct s_fork_node
+{
+	char						unused;
+}								t_fork_node;
+
+typedef struct s_fork_lock
+{
+	pthread_mutex_t				mutex;
+}								t_fork_lock;
+
+# endif
+
+typedef enum e_trace_mode
+{
+	TRACE_OFF = 0,
+	TRACE_RECORD = 1,
+	TRACE_REPLAY = 2
+}								t_trace_mode;
+
+typedef enum e_trace_kind
+{
+	TRACE_FORK = 0,
+	TRACE_WAKEUP = 1,
+	TRACE_DIED = 2
+}								t_trace_kind;
+
+typedef struct s_trace_event
+{
+	uint16_t					philosopher;
+	uint8_t						kind;
+	uint8_t						slot;
+	uint32_t					time;
+}								t_trace_event;
+
+typedef struct s_trace_header
+{
+	uint32_t					magic;
+	uint32_t					version;
+	uint32_t					num_philosophers;
+	uint32_t					num_forks;
+	int32_t						must_eat_count;
+	uint32_t					time_to_die;
+	uint32_t					time_to_eat;
+	uint32_t					time_to_sleep;
+	uint64_t					num_events;
+}								t_trace_header;
+
+typedef struct s_trace
+{
+	t_trace_mode				mode;
+	char						*path;
+	int							fd;
+	size_t						capacity;
+	t_trace_header				*header;
+	t_trace_event				*events;
+	atomic_size_t				next;
+	atomic_bool					diverged;
+}								t_trace;
+
+typedef enum e_fork_acquisition
+{
+	FORK_BLOCKING = 0,
+	FORK_BACKOFF = 1
+}								t_fork_acquisition;
+
+typedef enum e_output_mode
+{
+	OUTPUT_PLAIN = 0,
+	OUTPUT_DEBUG = 1,
+	OUTPUT_COMPRESSED = 2
+}								t_output_mode;
+
+typedef enum e_pinning
+{
+	PIN_NONE = 0,
+	PIN_CORES = 1
+}								t_pinning;
+
+typedef enum e_writer
+{
+	WRITER_LOCKED = 0,
+	WRITER_MERGED = 1
+}								t_writer;
+
+typedef enum e_output_io
+{
+	OUTPUT_WRITEV = 0,
+	OUTPUT_WRITE = 1
+}								t_output_io;
+
+typedef enum e_profile
+{
+	PROFILE_OFF = 0,
+	PROFILE_STATES = 1,
+	PROFILE_MEMORY = 2,
+	PROFILE_CLASSES = 3
+}								t_profile;
+
+typedef enum e_oracle
+{
+	ORACLE_OFF = 0,
+	ORACLE_PLAN = 1,
+	ORACLE_COMPARE = 2
+}								t_oracle;
+
+typedef enum e_schedule_mode
+{
+	SCHEDULE_DYNAMIC = 0,
+	SCHEDULE_STATIC = 1
+}								t_schedule_mode;
+
+typedef enum e_footprint
+{
+	FOOTPRINT_DEFAULT = 0,
+	FOOTPRINT_LOW = 1
+}								t_footprint;
+
+typedef enum e_realtime
+{
+	REALTIME_OFF = 0,
+	REALTIME_FIFO = 1
+}								t_realtime;
+
+typedef struct s_settings
+{
+	int							num_philosophers;
+	int							time_to_die;
+	int							time_to_eat;
+	int							time_to_sleep;
+	int							must_eat_count;
+	int							max_philosophers;
+	int							sleep_granularity_us;
+	int							reaper_interval_us;
+	int							noise_seed;
+	int							noise_max_us;
+	int							flush_interval_us;
+	int							processes;
+	int							stack_size_kb;
+	int							jitter_seed;
+	int							churn_interval_us;
+	int							churn_seed;
+	int							checkpoint_interval_ms;
+	int							sleep_spin_us;
+	int							think_slack_ms;
+	int							calibration_ms;
+	t_output_mode				output_mode;
+	t_writer					writer;
+	t_output_io					output_io;
+	t_fork_acquisition			fork_acquisition;
+	t_pinning					pinning;
+	t_profile					profile;
+	t_oracle					oracle;
+	t_schedule_mode				schedule;
+	t_footprint					footprint;
+	t_realtime					realtime;
+	char						*preset;
+	char						*topology;
+	char						*timings;
+	char						*record;
+	char						*replay;
+	char						*checkpoint;
+	char						*resume;
+	char						*calibration;
+}								t_settings;
+
+/* The wakeups measured by calibrate: one counter per microsecond that a
+ * sleep overshot the requested time, the last one counting every
+ * overshoot of CALIBRATION_BUCKETS microseconds or more. */
+typedef struct s_calibration
+{
+	t_settings					*settings;
+	uint64_t					end;
+	atomic_uint					*histogram;
+}								t_calibration;
+
+typedef struct s_output_event
+{
+	uint64_t					time;
+	uint32_t					fork;
+	uint16_t					philosopher;
+	uint8_t						status;
+}								t_output_event;
+
+/* One philosopher's events waiting for the merger. Only the philosopher
+ * moves head and pending, only the merger moves tail, so they live on
+ * separate cache lines. pending is OUTPUT_IDLE, OUTPUT_BUSY while the
+ * philosopher reads the clock, then the time of the event being added. */
+typedef struct s_output_ring
+{
+	_Alignas(CACHE_LINE_SIZE) atomic_uint_fast64_t	pending;
+	atomic_size_t				head;
+	_Alignas(CACHE_LINE_SIZE) atomic_size_t	tail;
+	size_t						next;
+	size_t						limit;
+	t_output_event				*events;
+}								t_output_ring;
+
+/* The "compressed" output of the output thread, or its decoder. Events
+ * are coded into bytes in block: the status from the dictionary of
+ * status_message, the timestamp as a delta from the last one and the
+ * philosopher only if he changed. A full block, or one opened more than
+ * CODEC_SEAL_MS ago, is then compressed by lz_compress into the output
+ * buffer, after its raw and compressed sizes. The stream starts with
+ * CODEC_MAGIC and ends with an empty block; whatever follows it, such
+ * as a warning, is plain text. */
+typedef struct s_output_codec
+{
+	unsigned char				*block;
+	size_t						length;
+	uint32_t					*hash;
+	long						timestamp;
+	unsigned int				philosopher;
+	time_t						opened;
+	bool						started;
+	unsigned long				text_bytes;
+	unsigned long				compressed_bytes;
+}								t_output_codec;
+
+/* The output buffers form a queue handed from the output thread, which
+ * fills them, to the writer thread, which writes them out: num_ready
+ * buffers from first_ready are full, and the output thread fills the
+ * one after them, current. */
+typedef struct s_output
+{
+	t_output_ring				*rings;
+	unsigned int				*heap;
+	unsigned int				heap_size;
+	char						*pool;
+	size_t						lengths[OUTPUT_BUFFERS];
+	unsigned int				current;
+	unsigned int				first_ready;
+	unsigned int				num_ready;
+	char						*buffer;
+	size_t						length;
+	t_output_io					io;
+	bool						writer_sync;
+	bool						writer_started;
+	bool						writer_done;
+	pthread_mutex_t				writer_lock;
+	pthread_cond_t				writer_cond;
+	pthread_t					writer_thread;
+	unsigned long				events;
+	unsigned long				syscalls;
+	unsigned long				dropped_bytes;
+	t_output_codec				codec;
+	pthread_t					thread;
+	bool						started;
+	bool						closed;
+	atomic_bool					finish;
+	atomic_int					dead_philosopher;
+	atomic_uint_fast64_t		death_time;
+}								t_output;
+
+typedef struct s_topology
+{
+	unsigned int				num_edges;
+	unsigned int				*edge_philosopher;
+	unsigned int				*edge_fork;
+	unsigned int				num_forks;
+	unsigned int				*fork_user_start;
+	unsigned int				*fork_users;
+	int							*fork_color;
+}								t_topology;
+
+/* The memory shared with the worker processes, from a single mapping
+ * that starts with this header. */
+typedef struct s_arena
+{
+	size_t						size;
+	size_t						used;
+}								t_arena;
+
+/* A periodic schedule for the default ring of forks, as a circular
+ * coloring: the period is split into num_slots slots of slot_ns, a meal
+ * takes slots_per_meal of them, and the philosopher with id i starts
+ * eating at slot (i * slots_per_meal) % num_slots of every period.
+ * Neighbors always start at least slots_per_meal slots apart, so they
+ * never need their shared fork at the same time. */
+typedef struct s_schedule
+{
+	bool						exists;
+	bool						survivable;
+	unsigned int				num_slots;
+	unsigned int				slots_per_meal;
+	uint64_t					slot_ns;
+	uint64_t					period_ns;
+}								t_schedule;
+
+/* The stacks of the philosophers' threads in the "low" footprint mode:
+ * one mapping split into slots of slot_size bytes, each starting with a
+ * guard page followed by the stack itself. */
+typedef struct s_thread_stacks
+{
+	char						*region;
+	size_t						region_size;
+	size_t						slot_size;
+	size_t						guard_size;
+}								t_thread_stacks;
+
+/* The thread that turns SIGINT and SIGTERM into an orderly stop of the
+ * simulation, and SIGUSR1 into a snapshot of the table. stop_signal is
+ * the signal that stopped the run, or 0. */
+typedef struct s_signal_watcher
+{
+	int							signal_fd;
+	int							wakeup_fd;
+	pthread_t					thread;
+	bool						started;
+	atomic_int					stop_signal;
+}								t_signal_watcher;
+
+/* The readers of the seating, each announcing the epoch it entered at
+ * in its own entry of the membership's readers. */
+typedef enum e_seating_reader
+{
+	READER_REAPER = 0,
+	READER_SIGNALS = 1
+}								t_seating_reader;
+
+/* The philosophers seated at the table, as indexes in the table's
+ * philosophers array, in the order of the ring. A seating is never
+ * changed once published: each join or leave publishes a new one and
+ * retires the old one, tagged with the epoch it was retired at. departed
+ * is the index of the philosopher who left in that change, or NO_SEAT. */
+typedef struct s_seating
+{
+	struct s_seating			*next_retired;
+	uint64_t					retired_epoch;
+	unsigned int				departed;
+	unsigned int				count;
+	unsigned int				seats[];
+}								t_seating;
+
+/* The state of the membership churn. Only the membership thread
+ * publishes seatings and touches the retired list and the free
+ * indexes; the readers only announce their epoch while they scan. */
+typedef struct s_membership
+{
+	t_seating *_Atomic			seating;
+	atomic_uint_fast64_t		epoch;
+	atomic_uint_fast64_t		readers[MEMBERSHIP_READERS];
+	t_seating					*retired;
+	unsigned int				*free_seats;
+	unsigned int				num_free;
+	unsigned int				next_id;
+	unsigned int				seed;
+	unsigned long				joins;
+	unsigned long				leaves;
+	pthread_t					thread;
+	bool						started;
+}								t_membership;
+
+/* The start of a checkpoint file, followed by CHECKPOINT_SLOTS slots.
+ * Checkpoints are written to the slot after current, which is only
+ * moved to them once they are complete, so that a crash in the middle
+ * of one leaves the previous checkpoint intact. Everything up to
+ * current must match for a checkpoint to be resumed. */
+typedef struct s_checkpoint_header
+{
+	uint32_t					magic;
+	uint32_t					version;
+	uint32_t					num_philosophers;
+	uint32_t					num_forks;
+	int32_t						must_eat_count;
+	uint32_t					time_to_die;
+	uint32_t					time_to_eat;
+	uint32_t					time_to_sleep;
+	uint32_t					fork_acquisition;
+	uint32_t					current;
+}								t_checkpoint_header;
+
+/* One philosopher in a checkpoint. Times are relative to the moment he
+ * was checkpointed: how long he had gone without eating, and how long
+ * his meal or nap still had to last. Whether he held his forks follows
+ * from his phase: only an eating philosopher holds all of them. */
+typedef struct s_checkpoint_record
+{
+	uint32_t					times_ate;
+	uint32_t					hunger_ms;
+	uint32_t					longest_hunger_ms;
+	int32_t						phase_left_ms;
+	uint32_t					phase;
+	uint32_t					jitter_seed;
+	uint32_t					backoff_seed;
+	uint32_t					noise_seed;
+}								t_checkpoint_record;
+
+typedef struct s_checkpoint_slot
+{
+	uint64_t					sequence;
+	uint64_t					elapsed_ms;
+	t_checkpoint_record			records[];
+}								t_checkpoint_slot;
+
+/* The checkpoints of the run, mapped from their file, and the records
+ * of the checkpoint it resumes from until the simulation starts. The
+ * cost of the checkpoints is kept both in wall clock time and in CPU
+ * time of the checkpoint thread, and retries counts the records read
+ * again because their philosopher was publishing them. */
+typedef struct s_checkpoint
+{
+	int							fd;
+	size_t						size;
+	t_checkpoint_header			*header;
+	t_checkpoint_record			*records;
+	uint64_t					resumed_ms;
+	bool						resumed;
+	pthread_t					thread;
+	bool						started;
+	unsigned long				taken;
+	unsigned long				retries;
+	uint64_t					longest_ns;
+	uint64_t					longest_cpu_ns;
+	uint64_t					total_ns;
+}								t_checkpoint;
+
 typedef struct s_dining_table
 {
 	int							must_eat_count;
@@ -63,54 +713,370 @@ typedef struct s_dining_table
 	time_t						time_to_eat;
 	time_t						time_to_sleep;
 	unsigned int				num_philosophers;
+	unsigned int				num_forks;
+	unsigned int				num_classes;
+	unsigned int				capacity;
+	t_settings					settings;
+	t_trace						trace;
+	t_output					output;
+	t_schedule					schedule;
+	t_signal_watcher			signals;
+	t_thread_stacks				stacks;
+	t_membership				membership;
+	t_checkpoint				checkpoint;
+	t_arena						*arena;
+	pid_t						*workers;
+	unsigned int				num_workers;
 	pthread_t					grim_reaper_thread;
+	unsigned int				noise_seed;
 	bool						simulation_stopped;
 	pthread_mutex_t				simulation_stop_lock;
 	pthread_mutex_t				write_lock;
-	pthread_mutex_t				*fork_locks;
+	t_fork_lock					*fork_locks;
 	t_philosopher				**philosophers;
 }								t_dining_table;
 
+typedef enum e_profile_state
+{
+	STATE_THINKING = 0,
+	STATE_FIRST_FORK = 1,
+	STATE_OTHER_FORKS = 2,
+	STATE_EATING = 3,
+	STATE_SLEEPING = 4,
+	STATE_OVERHEAD = 5,
+	NUM_STATES = 6
+}								t_profile_state;
+
+/* Where a philosopher's time went with the "states" profile. Only the
+ * philosopher's own thread updates it, and it is only read once that
+ * thread was joined, so it needs no lock. */
+typedef struct s_state_profile
+{
+	t_profile_state				state;
+	uint64_t					since;
+	uint64_t					time_ns[NUM_STATES];
+}								t_state_profile;
+
+typedef enum e_philosopher_status
+{
+	PHILO_DIED = 0,
+	PHILO_EATING = 1,
+	PHILO_SLEEPING = 2,
+	PHILO_THINKING = 3,
+	PHILO_GOT_FORK = 4
+}								t_philosopher_status;
+
+/* Where a philosopher stands in his routine, for the checkpoints: a copy
+ * of his state that he publishes as he starts eating, sleeping or
+ * thinking, with the end of his meal or nap. Only he writes it, and the
+ * checkpoint thread reads it without a lock, so that a checkpoint never
+ * makes him wait: sequence is odd while he writes, and a reader who sees
+ * it change reads again (see read_phase). */
+typedef struct s_phase
+{
+	atomic_uint					sequence;
+	atomic_uint					status;
+	atomic_long					end;
+	atomic_uint					times_ate;
+	atomic_long					last_meal_time;
+	atomic_long					longest_hunger;
+	atomic_uint					jitter_seed;
+	atomic_uint					backoff_seed;
+	atomic_uint					noise_seed;
+}								t_phase;
+
 typedef struct s_philosopher
 {
 	pthread_t					thread;
 	unsigned int				id;
+	unsigned int				index;
+	atomic_uint					right_fork;
+	atomic_bool					leaving;
+	unsigned int				timing_class;
+	time_t						time_to_die;
+	time_t						time_to_eat;
+	time_t						time_to_sleep;
+	unsigned int				jitter_ms;
+	unsigned int				jitter_seed;
 	unsigned int				times_ate;
-	unsigned int				fork[2];
+	unsigned int				num_forks;
+	unsigned int				*forks;
+	t_fork_node					*fork_nodes;
+	unsigned int				forks_held;
+	atomic_uint					fork_waits;
+	unsigned int				backoff_seed;
+	unsigned int				noise_seed;
+	int							realtime_level;
 	pthread_mutex_t				last_meal_lock;
 	time_t						last_meal_time;
+	time_t						longest_hunger;
+	t_phase						phase;
+	bool						died;
+	t_state_profile				profile;
 	t_dining_table				*dining_table;
 }								t_philosopher;
 
-typedef enum e_philosopher_status
+/* The totals of one timing class for the "classes" profile, summed over
+ * its philosophers once their threads were joined. */
+typedef struct s_class_stats
 {
-	PHILO_DIED = 0,
-	PHILO_EATING = 1,
-	PHILO_SLEEPING = 2,
-	PHILO_THINKING = 3,
-	PHILO_GOT_FORK_1 = 4,
-	PHILO_GOT_FORK_2 = 5
-}								t_philosopher_status;
+	t_philosopher				*first;
+	unsigned int				count;
+	unsigned long				meals;
+	double						meals_squared;
+	time_t						worst_hunger;
+	time_t						min_slack;
+	unsigned int				deaths;
+}								t_class_stats;
 
 /* Function Prototypes */
 
 /* table_initialization.c */
-t_dining_table			*init_dining_table(int argc, char **argv,
-							int index);
+t_dining_table			*init_dining_table(t_settings *settings);
+
+/* settings.c */
+void					init_default_settings(t_settings *settings);
+bool					apply_setting(t_settings *settings, char *key,
+							char *value);
+
+/* settings_loader.c */
+bool					load_settings(t_settings *settings, int argc,
+							char **argv);
+void					free_settings(t_settings *settings);
+
+/* settings_parser.c */
+bool					apply_config_text(t_settings *settings,
+							char *text, char *section, bool *found);
+
+/* settings_presets.c */
+bool					apply_presets(t_settings *settings, char *names,
+							char *config_text);
+
+/* utils.c */
+char					*read_text_file(char *path);
+char					*trim_whitespace(char *str);
+void					pin_thread(t_dining_table *dining_table,
+							pthread_t thread, unsigned int index);
+
+/* shared_memory.c */
+t_arena					*create_arena(t_settings *settings);
+void					*arena_alloc(t_arena *arena, size_t size,
+							size_t alignment);
+void					*table_alloc(t_dining_table *dining_table,
+							size_t size, size_t alignment);
+void					table_free(t_dining_table *dining_table,
+							void *memory);
+bool					table_mutex_init(t_dining_table *dining_table,
+							pthread_mutex_t *mutex);
+
+/* signal_watcher.c */
+bool					start_signal_watcher(t_dining_table *dining_table);
+void					stop_signal_watcher(t_dining_table *dining_table);
+
+/* thread_stacks.c */
+bool					init_thread_stacks(t_dining_table *dining_table);
+bool					create_philosopher_thread(
+							t_dining_table *dining_table, unsigned int i);
+void					free_thread_stacks(t_dining_table *dining_table);
+
+/* membership.c */
+unsigned int			table_capacity(t_settings *settings);
+bool					init_membership(t_dining_table *dining_table);
+t_seating				*enter_seating(t_dining_table *dining_table,
+							t_seating_reader reader);
+void					leave_seating(t_dining_table *dining_table,
+							t_seating_reader reader);
+t_philosopher			*seated_philosopher(t_dining_table *dining_table,
+							t_seating *seating, unsigned int i);
+void					update_ring_forks(t_philosopher *philosopher);
+void					publish_seating(t_membership *membership,
+							t_seating *seating, unsigned int departed);
+void					reclaim_seatings(t_dining_table *dining_table,
+							bool wait);
+void					free_membership(t_dining_table *dining_table);
+
+/* membership_churn.c */
+bool					start_membership(t_dining_table *dining_table);
+void					stop_membership(t_dining_table *dining_table);
+void					seat_final_philosophers(t_dining_table *dining_table);
+void					print_membership_report(t_dining_table *dining_table);
+
+/* checkpoint_file.c */
+t_checkpoint_slot		*checkpoint_slot(t_checkpoint_header *header,
+							unsigned int slot);
+bool					load_checkpoint(t_dining_table *dining_table,
+							char *path);
+bool					open_checkpoint(t_dining_table *dining_table,
+							char *path);
+void					resume_checkpoint(t_dining_table *dining_table);
+void					close_checkpoint(t_checkpoint *checkpoint);
+
+/* checkpoint.c */
+void					record_phase(t_philosopher *philosopher,
+							t_philosopher_status status, time_t end);
+bool					start_checkpoints(t_dining_table *dining_table);
+void					stop_checkpoints(t_dining_table *dining_table);
+void					print_checkpoint_report(t_dining_table *dining_table);
+
+/* calibration.c */
+bool					calibrate(t_settings *settings);
+
+/* realtime.c */
+void					check_realtime(t_dining_table *dining_table);
+bool					set_realtime_priority(t_dining_table *dining_table,
+							int level);
+void					update_realtime_priority(t_philosopher *philosopher);
+
+/* memory_report.c */
+void					print_memory_report(t_dining_table *dining_table);
+
+/* worker_processes.c */
+bool					start_workers(t_dining_table *dining_table);
+void					wait_workers(t_dining_table *dining_table);
+
+/* topology_loader.c */
+int						next_number(char **cursor, unsigned int *value);
+bool					load_topology(t_dining_table *dining_table,
+							char *path);
+
+/* timings_loader.c */
+bool					load_timings(t_dining_table *dining_table,
+							char *path);
+
+/* timings.c */
+void					init_philosopher_timings(t_philosopher *philosopher);
+time_t					jittered_duration(t_philosopher *philosopher,
+							time_t duration);
+void					record_meal_start(t_philosopher *philosopher,
+							time_t now);
+
+/* topology_graph.c */
+bool					apply_topology(t_dining_table *dining_table,
+							t_topology *topology);
+void					free_topology(t_topology *topology);
+
+/* topology_coloring.c */
+bool					color_forks(t_topology *topology,
+							t_dining_table *dining_table);
+void					order_forks_by_color(t_philosopher *philosopher,
+							int *fork_color);
+
+/* fork_acquisition.c */
+bool					take_forks(t_philosopher *philosopher);
+void					release_forks(t_philosopher *philosopher);
+
+/* fork_lock_*.c, depending on FORK_LOCK */
+bool					fork_lock_init(t_fork_lock *lock, bool shared);
+void					fork_lock_destroy(t_fork_lock *lock);
+void					fork_lock_acquire(t_fork_lock *lock, t_fork_node *node);
+bool					fork_lock_try_acquire(t_fork_lock *lock,
+							t_fork_node *node);
+void					fork_lock_release(t_fork_lock *lock, t_fork_node *node);
+
+/* profile.c */
+void					profile_start(t_philosopher *philosopher);
+void					profile_transition(t_philosopher *philosopher,
+							t_profile_state state);
+uint64_t				profile_overhead_start(t_philosopher *philosopher);
+void					profile_overhead_end(t_philosopher *philosopher,
+							uint64_t start);
+void					profile_probe(unsigned int id, int state);
+
+/* profile_report.c */
+void					print_profile_report(t_dining_table *dining_table);
+
+/* class_report.c */
+void					print_class_report(t_dining_table *dining_table);
+
+/* schedule.c */
+void					plan_schedule(t_dining_table *dining_table);
+uint64_t				schedule_offset(t_schedule *schedule,
+							unsigned int id);
+
+/* oracle.c */
+void					print_oracle_plan(t_dining_table *dining_table);
+void					print_oracle_comparison(t_dining_table *dining_table);
+
+/* stress_noise.c */
+void					noise_point(t_dining_table *dining_table,
+							unsigned int *seed);
+
+/* table_options.c */
+bool					load_table_options(t_dining_table *dining_table);
+
+/* trace_file.c */
+bool					open_trace(t_dining_table *dining_table,
+							t_trace_mode mode, char *path);
+void					close_trace(t_trace *trace);
+
+/* trace_events.c */
+void					trace_before(t_philosopher *philosopher,
+							t_trace_kind kind, unsigned int slot);
+void					trace_after(t_philosopher *philosopher,
+							t_trace_kind kind, unsigned int slot);
+t_philosopher			*trace_next_death(t_dining_table *dining_table);
 
 /* input_validation.c */
 bool					is_valid_input(int argc, char **argv);
 int						parse_integer(char *str);
+bool					parse_unsigned(char *str, int *value);
+int						parse_choice(char *str, char *choices);
 
 /* philosopher_routines.c */
 void					*philosopher_routine(void *data);
 
 /* time_management.c */
 time_t					get_current_time_in_ms(void);
-void					philosopher_sleep(t_dining_table *dining_table,
+uint64_t				get_current_time_in_ns(void);
+void					philosopher_sleep(t_philosopher *philosopher,
 							time_t sleep_duration);
+void					philosopher_sleep_until(t_philosopher *philosopher,
+							uint64_t wake_up_time);
 void					delay_simulation_start(time_t start_time);
 
+/* output_format.c */
+char					*status_message(t_philosopher_status status);
+char					*status_color(t_philosopher_status status);
+size_t					format_event(t_dining_table *dining_table,
+							t_output_event *event, char *buffer);
+
+/* output_buffer.c */
+bool					init_output(t_dining_table *dining_table);
+void					push_output_event(t_philosopher *philosopher,
+							t_philosopher_status status);
+void					report_output_death(t_philosopher *philosopher);
+void					free_output(t_dining_table *dining_table);
+
+/* output_merger.c */
+void					*output_routine(void *data);
+
+/* output_writer.c */
+void					flush_output(t_output *output);
+void					start_output_writer(t_output *output);
+void					stop_output_writer(t_output *output);
+void					print_dropped_output(t_output *output);
+
+/* output_codec.c */
+void					encode_output_event(t_dining_table *dining_table,
+							t_output_event *event);
+void					seal_output_block(t_output *output, bool force);
+void					finish_output_codec(t_output *output);
+bool					decode_output_block(t_output_codec *codec,
+							unsigned char *block, FILE *out);
+void					print_compression_report(t_dining_table *dining_table);
+
+/* output_lz.c */
+size_t					lz_compress(unsigned char *source, size_t length,
+							unsigned char *destination, uint32_t *hash);
+bool					lz_decompress(unsigned char *source, size_t length,
+							unsigned char *destination, size_t expected);
+
+/* output_heap.c */
+void					build_output_heap(t_output *output,
+							unsigned int num_rings);
+t_output_event			*output_heap_top(t_output *output);
+void					pop_output_heap(t_output *output);
+
 /* output.c */
 void					philo_stat(t_philosopher *philosopher,
 							bool is_reaper,
@@ -119,6 +1085,8 @@ void					print_simulation_outcome(t_dining_table *dining_table);
 
 /* grim_reaper.c */
 void					*grim_reaper_routine(void *data);
+void					set_simulation_stop_flag(t_dining_table *dining_table,
+							bool state);
 bool					is_simulation_stopped(t_dining_table *dining_table);
 
 /* cleanup.c */
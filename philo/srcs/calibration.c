@@ -0,0 +1,300 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   calibration.c                                      :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: antestem <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/07/11 17:01:52 by antestem          #+#    #+#             */
+/*   Updated: 2024/07/11 17:01:53 by antestem         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "philosophers.h"
+
+/* measure_wakeup:
+ *   Sleeps once like a philosopher checking on the simulation does: for
+ *   sleep_granularity_us, with usleep or, with the static schedule, on
+ *   the absolute clock (see philosopher_sleep_until). Then measures how
+ *   late the thread woke up.
+ *
+ *   Parameters:
+ *     - settings: Pointer to the settings structure.
+ *
+ *   Returns:
+ *     - The overshoot in microseconds, at most CALIBRATION_BUCKETS.
+ */
+static unsigned int	measure_wakeup(t_settings *settings)
+{
+	struct timespec	ts;
+	uint64_t		target;
+	uint64_t		now;
+
+	target = get_current_time_in_ns()
+		+ (uint64_t)settings->sleep_granularity_us * 1000;
+	if (settings->schedule == SCHEDULE_STATIC)
+	{
+		ts.tv_sec = target / 1000000000;
+		ts.tv_nsec = target % 1000000000;
+		while (clock_nanosleep(CLOCK_REALTIME, TIMER_ABSTIME, &ts, NULL)
+			== EINTR)
+			continue ;
+	}
+	else
+		usleep(settings->sleep_granularity_us);
+	now = get_current_time_in_ns();
+	if (now <= target)
+		return (0);
+	if ((now - target) / 1000 >= CALIBRATION_BUCKETS)
+		return (CALIBRATION_BUCKETS);
+	return ((now - target) / 1000);
+}
+
+/* calibration_routine:
+ *   The routine of the calibration threads, one per philosopher: sleeps
+ *   and counts the overshoot of every wakeup until the end of the
+ *   calibration.
+ *
+ *   Parameters:
+ *     - data: Pointer to the t_calibration structure.
+ *
+ *   Returns:
+ *     - A NULL pointer.
+ */
+static void	*calibration_routine(void *data)
+{
+	t_calibration	*calibration;
+
+	calibration = (t_calibration *)data;
+	while (get_current_time_in_ns() < calibration->end)
+		atomic_fetch_add_explicit(&calibration->histogram[measure_wakeup(
+				calibration->settings)], 1, memory_order_relaxed);
+	return (NULL);
+}
+
+/* measure_calibration:
+ *   Runs as many calibration threads as there will be philosophers, for
+ *   calibration_ms, so that the wakeups compete for the cores like the
+ *   philosophers' will. The threads get the small stacks of the "low"
+ *   footprint, which is all they need.
+ *
+ *   Parameters:
+ *     - calibration: Pointer to the t_calibration structure.
+ *
+ *   Returns:
+ *     - The number of wakeups measured, 0 if no thread could start.
+ */
+static unsigned long	measure_calibration(t_calibration *calibration)
+{
+	pthread_t		*threads;
+	pthread_attr_t	attributes;
+	unsigned int	count;
+	unsigned long	total;
+
+	threads = malloc(sizeof(pthread_t)
+			* calibration->settings->num_philosophers);
+	if (!threads || pthread_attr_init(&attributes) != 0)
+	{
+		free(threads);
+		return (0);
+	}
+	pthread_attr_setstacksize(&attributes,
+		(size_t)calibration->settings->stack_size_kb * 1024);
+	calibration->end = get_current_time_in_ns()
+		+ (uint64_t)calibration->settings->calibration_ms * 1000000;
+	count = 0;
+	while (count < (unsigned int)calibration->settings->num_philosophers
+		&& pthread_create(&threads[count], &attributes,
+			&calibration_routine, calibration) == 0)
+		count++;
+	pthread_attr_destroy(&attributes);
+	while (count > 0)
+		pthread_join(threads[--count], NULL);
+	free(threads);
+	total = 0;
+	while (count <= CALIBRATION_BUCKETS)
+		total += calibration->histogram[count++];
+	return (total);
+}
+
+/* overshoot_percentile:
+ *   Finds a percentile of the measured overshoots.
+ *
+ *   Parameters:
+ *     - histogram: The counts of the overshoots, per microsecond.
+ *     - total: The number of wakeups measured.
+ *     - rank: The percentile, in thousandths of a percent (99900 for
+ *       the 99.9th percentile, 100000 for the maximum).
+ *
+ *   Returns:
+ *     - The overshoot in microseconds.
+ */
+static unsigned int	overshoot_percentile(atomic_uint *histogram,
+		unsigned long total, unsigned long rank)
+{
+	unsigned long	seen;
+	unsigned int	us;
+
+	seen = 0;
+	us = 0;
+	while (us < CALIBRATION_BUCKETS)
+	{
+		seen += histogram[us];
+		if (seen * 100000 >= total * rank)
+			return (us);
+		us++;
+	}
+	return (CALIBRATION_BUCKETS);
+}
+
+/* derive_margins:
+ *   Prints the measured overshoots and derives the safety margins from
+ *   them:
+ *     - sleep_spin_us: philosopher_sleep stops sleeping this long before
+ *       its wakeup time and spins the rest, so the 99th percentile of
+ *       the overshoot. Spinning only helps while every thread has a core
+ *       of its own, so it stays 0 when the philosophers outnumber them.
+ *     - reaper_interval_us: the grim reaper's usleep overshoots too, by
+ *       the median, which is taken off its interval so that it still
+ *       checks the philosophers about every REAPER_INTERVAL_US.
+ *     - think_slack_ms: a philosopher comes back from thinking this much
+ *       earlier, to make up for the 99th percentile of the overshoot.
+ *
+ *   Parameters:
+ *     - calibration: Pointer to the t_calibration structure.
+ *     - total: The number of wakeups measured.
+ */
+static void	derive_margins(t_calibration *calibration, unsigned long total)
+{
+	t_settings		*settings;
+	unsigned int	median;
+	unsigned int	high;
+
+	settings = calibration->settings;
+	median = overshoot_percentile(calibration->histogram, total, 50000);
+	high = overshoot_percentile(calibration->histogram, total, 99000);
+	fprintf(stderr, "calibration: %d threads, %lu wakeups of %d us: "
+		"overshoot p50 %u, p99 %u, p99.9 %u, max %u us\n",
+		settings->num_philosophers, total, settings->sleep_granularity_us,
+		median, high, overshoot_percentile(calibration->histogram, total,
+			99900), overshoot_percentile(calibration->histogram, total,
+			100000));
+	settings->sleep_spin_us = 0;
+	if (settings->num_philosophers < sysconf(_SC_NPROCESSORS_ONLN))
+		settings->sleep_spin_us = high;
+	if (settings->sleep_spin_us > CALIBRATION_MAX_SPIN_US)
+		settings->sleep_spin_us = CALIBRATION_MAX_SPIN_US;
+	settings->reaper_interval_us = REAPER_MIN_INTERVAL_US;
+	if (median + REAPER_MIN_INTERVAL_US < REAPER_INTERVAL_US)
+		settings->reaper_interval_us = REAPER_INTERVAL_US - median;
+	settings->think_slack_ms = (high + 999) / 1000;
+}
+
+/* save_calibration:
+ *   Appends the derived margins to the calibration file, as a section
+ *   in the config format, so that later runs with the same sleep
+ *   primitive and number of threads load them instead of measuring.
+ *
+ *   Parameters:
+ *     - settings: Pointer to the settings structure.
+ *     - section: The name of the section.
+ *
+ *   Returns:
+ *     - A boolean indicating whether the file was written.
+ */
+static bool	save_calibration(t_settings *settings, char *section)
+{
+	FILE	*file;
+	int		written;
+
+	file = fopen(settings->calibration, "a");
+	if (!file)
+		return (false);
+	written = fprintf(file, "[%s]\nsleep_spin_us = %d\n"
+			"reaper_interval_us = %d\nthink_slack_ms = %d\n\n", section,
+			settings->sleep_spin_us, settings->reaper_interval_us,
+			settings->think_slack_ms);
+	if (fclose(file) != 0)
+		return (false);
+	return (written > 0);
+}
+
+/* measure_margins:
+ *   Measures the wakeups, derives the margins and saves them.
+ *
+ *   Parameters:
+ *     - settings: Pointer to the settings structure.
+ *     - section: The name of the section to save them under.
+ *
+ *   Returns:
+ *     - A boolean indicating whether the margins were measured and
+ *       saved.
+ */
+static bool	measure_margins(t_settings *settings, char *section)
+{
+	t_calibration	calibration;
+	unsigned long	total;
+
+	calibration.settings = settings;
+	calibration.histogram = calloc(CALIBRATION_BUCKETS + 1,
+			sizeof(atomic_uint));
+	if (!calibration.histogram)
+		return (print_message(ERROR_MEMORY_ALLOCATION, NULL, false));
+	total = measure_calibration(&calibration);
+	if (total > 0)
+		derive_margins(&calibration, total);
+	free(calibration.histogram);
+	if (total == 0)
+		return (print_message(ERROR_THREAD_CREATION, NULL, false));
+	if (!save_calibration(settings, section))
+		return (print_message(ERROR_CALIBRATION_FILE, settings->calibration,
+				false));
+	return (true);
+}
+
+/* calibrate:
+ *   Sets the safety margins of the sleeps from the wakeup latency of the
+ *   host, which decides whether tight runs such as 4 410 200 200
+ *   survive. The margins are looked up in the calibration file under a
+ *   section named after the sleep primitive, its granularity and the
+ *   number of threads, such as [usleep-100us-4threads]. If there is
+ *   none, they are measured, cyclictest-style, and added to the file.
+ *   Either way they replace the sleep_spin_us, reaper_interval_us and
+ *   think_slack_ms settings.
+ *
+ *   Parameters:
+ *     - settings: Pointer to the loaded settings.
+ *
+ *   Returns:
+ *     - A boolean indicating whether the margins were set.
+ */
+bool	calibrate(t_settings *settings)
+{
+	char	section[64];
+	char	*primitive;
+	char	*text;
+	bool	found;
+	bool	success;
+
+	primitive = "usleep";
+	if (settings->schedule == SCHEDULE_STATIC)
+		primitive = "nanosleep";
+	snprintf(section, sizeof(section), "%s-%dus-%dthreads", primitive,
+		settings->sleep_granularity_us, settings->num_philosophers);
+	found = false;
+	text = read_text_file(settings->calibration);
+	success = !text || apply_config_text(settings, text, section, &found);
+	free(text);
+	if (success && found
+		&& settings->reaper_interval_us < REAPER_MIN_INTERVAL_US)
+		success = print_message(ERROR_INVALID_SETTING, "reaper_interval_us",
+				false);
+	if (success && !found)
+		success = measure_margins(settings, section);
+	if (success)
+		fprintf(stderr, "calibration: [%s]: sleep_spin_us %d, "
+			"reaper_interval_us %d, think_slack_ms %d\n", section,
+			settings->sleep_spin_us, settings->reaper_interval_us,
+			settings->think_slack_ms);
+	return (success);
+}
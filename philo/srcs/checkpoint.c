@@ -0,0 +1,305 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   checkpoint.c                                       :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: antestem <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/07/11 17:01:50 by antestem          #+#    #+#             */
+/*   Updated: 2024/07/11 17:01:51 by antestem         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "philosophers.h"
+
+/* record_phase:
+ *   Publishes the state of a philosopher who starts eating, sleeping or
+ *   thinking, until the given end for a meal or a nap, for the
+ *   checkpoints to read without a lock. Only the philosopher's own
+ *   thread calls it, or the main thread before that one starts.
+ *
+ *   Parameters:
+ *     - philosopher: Pointer to the philosopher structure.
+ *     - status: PHILO_EATING, PHILO_SLEEPING or PHILO_THINKING.
+ *     - end: The time the meal or nap ends, in milliseconds.
+ */
+void	record_phase(t_philosopher *philosopher, t_philosopher_status status,
+		time_t end)
+{
+	t_phase			*phase;
+	unsigned int	sequence;
+
+	phase = &philosopher->phase;
+	sequence = atomic_load_explicit(&phase->sequence, memory_order_relaxed);
+	atomic_store_explicit(&phase->sequence, sequence + 1,
+		memory_order_relaxed);
+	atomic_thread_fence(memory_order_release);
+	atomic_store_explicit(&phase->status, status, memory_order_relaxed);
+	atomic_store_explicit(&phase->end, end, memory_order_relaxed);
+	atomic_store_explicit(&phase->times_ate, philosopher->times_ate,
+		memory_order_relaxed);
+	atomic_store_explicit(&phase->last_meal_time,
+		philosopher->last_meal_time, memory_order_relaxed);
+	atomic_store_explicit(&phase->longest_hunger,
+		philosopher->longest_hunger, memory_order_relaxed);
+	atomic_store_explicit(&phase->jitter_seed, philosopher->jitter_seed,
+		memory_order_relaxed);
+	atomic_store_explicit(&phase->backoff_seed, philosopher->backoff_seed,
+		memory_order_relaxed);
+	atomic_store_explicit(&phase->noise_seed, philosopher->noise_seed,
+		memory_order_relaxed);
+	atomic_store_explicit(&phase->sequence, sequence + 2,
+		memory_order_release);
+}
+
+/* read_phase:
+ *   Copies the state a philosopher last published into a checkpoint
+ *   record, reading it again for as long as he was publishing a new
+ *   one meanwhile. His meal times are still absolute.
+ *
+ *   Parameters:
+ *     - phase: Pointer to the philosopher's published state.
+ *     - record: Pointer to the record to fill.
+ *     - last_meal_time: Where to store the time of his last meal.
+ *     - end: Where to store the end of his meal or nap.
+ *
+ *   Returns:
+ *     - The number of times the state had to be read again.
+ */
+static unsigned int	read_phase(t_phase *phase, t_checkpoint_record *record,
+		time_t *last_meal_time, time_t *end)
+{
+	unsigned int	sequence;
+	unsigned int	retries;
+
+	retries = 0;
+	while (true)
+	{
+		sequence = atomic_load_explicit(&phase->sequence,
+				memory_order_acquire);
+		record->phase = atomic_load_explicit(&phase->status,
+				memory_order_relaxed);
+		*end = atomic_load_explicit(&phase->end, memory_order_relaxed);
+		record->times_ate = atomic_load_explicit(&phase->times_ate,
+				memory_order_relaxed);
+		*last_meal_time = atomic_load_explicit(&phase->last_meal_time,
+				memory_order_relaxed);
+		record->longest_hunger_ms = atomic_load_explicit(
+				&phase->longest_hunger, memory_order_relaxed);
+		record->jitter_seed = atomic_load_explicit(&phase->jitter_seed,
+				memory_order_relaxed);
+		record->backoff_seed = atomic_load_explicit(&phase->backoff_seed,
+				memory_order_relaxed);
+		record->noise_seed = atomic_load_explicit(&phase->noise_seed,
+				memory_order_relaxed);
+		atomic_thread_fence(memory_order_acquire);
+		if (!(sequence & 1) && sequence == atomic_load_explicit(
+				&phase->sequence, memory_order_relaxed))
+			return (retries);
+		retries++;
+		CPU_RELAX();
+	}
+}
+
+/* checkpoint_philosopher:
+ *   Records one philosopher, with his times relative to now: how long
+ *   he has gone without eating, and how long his meal or nap still has
+ *   to last. A philosopher who has not started yet counts from the start
+ *   of the simulation. The record is built on the stack and copied into
+ *   the mapping whole.
+ *
+ *   Parameters:
+ *     - checkpoint: Pointer to the checkpoint structure.
+ *     - philosopher: Pointer to the philosopher structure.
+ *     - record: Pointer to his record in the slot being written.
+ */
+static void	checkpoint_philosopher(t_checkpoint *checkpoint,
+		t_philosopher *philosopher, t_checkpoint_record *record)
+{
+	t_checkpoint_record	copy;
+	time_t				last_meal_time;
+	time_t				end;
+	time_t				now;
+
+	checkpoint->retries += read_phase(&philosopher->phase, &copy,
+			&last_meal_time, &end);
+	now = get_current_time_in_ms();
+	if (last_meal_time < philosopher->dining_table->start_time)
+		last_meal_time = philosopher->dining_table->start_time;
+	copy.hunger_ms = 0;
+	if (now > last_meal_time)
+		copy.hunger_ms = now - last_meal_time;
+	copy.phase_left_ms = 0;
+	if (copy.phase == PHILO_EATING || copy.phase == PHILO_SLEEPING)
+		copy.phase_left_ms = end - now;
+	else
+		copy.phase = PHILO_THINKING;
+	*record = copy;
+}
+
+/* thread_cpu_ns:
+ *   Returns the CPU time used by the calling thread, in nanoseconds.
+ */
+static uint64_t	thread_cpu_ns(void)
+{
+	struct timespec	ts;
+
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+	return ((uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec);
+}
+
+/* take_checkpoint:
+ *   Writes a checkpoint of every philosopher into the slot after the
+ *   current one, then makes it the current slot. The philosophers never
+ *   wait for it: each record is consistent on its own, as of the last
+ *   change of his phase, but neighbors are read a few microseconds
+ *   apart. Keeps the longest time a checkpoint took, on the wall clock
+ *   and in CPU time of this thread, which leaves out the time it was
+ *   preempted.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ */
+static void	take_checkpoint(t_dining_table *dining_table)
+{
+	t_checkpoint		*checkpoint;
+	t_checkpoint_slot	*slot;
+	uint32_t			next;
+	uint64_t			start;
+	uint64_t			cpu_start;
+	unsigned int		i;
+
+	checkpoint = &dining_table->checkpoint;
+	start = get_current_time_in_ns();
+	cpu_start = thread_cpu_ns();
+	next = 0;
+	if (checkpoint->header->current < CHECKPOINT_SLOTS)
+		next = (checkpoint->header->current + 1) % CHECKPOINT_SLOTS;
+	slot = checkpoint_slot(checkpoint->header, next);
+	i = 0;
+	while (i < dining_table->num_philosophers)
+	{
+		checkpoint_philosopher(checkpoint, dining_table->philosophers[i],
+			&slot->records[i]);
+		i++;
+	}
+	slot->sequence = 1;
+	if (checkpoint->header->current < CHECKPOINT_SLOTS)
+		slot->sequence += checkpoint_slot(checkpoint->header,
+				checkpoint->header->current)->sequence;
+	slot->elapsed_ms = checkpoint->resumed_ms + get_current_time_in_ms()
+		- dining_table->start_time;
+	atomic_thread_fence(memory_order_release);
+	checkpoint->header->current = next;
+	start = get_current_time_in_ns() - start;
+	cpu_start = thread_cpu_ns() - cpu_start;
+	checkpoint->taken++;
+	checkpoint->total_ns += start;
+	if (start > checkpoint->longest_ns)
+		checkpoint->longest_ns = start;
+	if (cpu_start > checkpoint->longest_cpu_ns)
+		checkpoint->longest_cpu_ns = cpu_start;
+}
+
+/* checkpoint_routine:
+ *   The checkpoint thread's routine. Once the simulation has started,
+ *   takes a checkpoint every checkpoint_interval_ms milliseconds, or at
+ *   every check for the stop if it is 0, checking for the stop at least
+ *   every reaper_interval_us. If a signal stopped the run, takes a last
+ *   checkpoint, so that the run can be resumed from where it stopped.
+ *
+ *   Parameters:
+ *     - data: Pointer to the dining_table structure.
+ *
+ *   Returns:
+ *     - A NULL pointer when the simulation stops.
+ */
+static void	*checkpoint_routine(void *data)
+{
+	t_dining_table	*dining_table;
+	uint64_t		next_checkpoint;
+	uint64_t		now;
+	uint64_t		pause;
+
+	dining_table = (t_dining_table *)data;
+	delay_simulation_start(dining_table->start_time);
+	next_checkpoint = get_current_time_in_ns()
+		+ (uint64_t)dining_table->settings.checkpoint_interval_ms * 1000000;
+	while (!is_simulation_stopped(dining_table))
+	{
+		now = get_current_time_in_ns();
+		if (now >= next_checkpoint)
+		{
+			take_checkpoint(dining_table);
+			next_checkpoint = now + (uint64_t)dining_table->settings.\
+			checkpoint_interval_ms * 1000000;
+		}
+		pause = dining_table->settings.reaper_interval_us;
+		if (next_checkpoint > now && (next_checkpoint - now) / 1000 < pause)
+			pause = (next_checkpoint - now) / 1000;
+		usleep(pause);
+	}
+	if (atomic_load(&dining_table->signals.stop_signal) != 0)
+		take_checkpoint(dining_table);
+	return (NULL);
+}
+
+/* start_checkpoints:
+ *   Starts the checkpoint thread, if a checkpoint file was given.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ *
+ *   Returns:
+ *     - A boolean indicating whether the thread, if needed, was created.
+ */
+bool	start_checkpoints(t_dining_table *dining_table)
+{
+	if (!dining_table->checkpoint.header)
+		return (true);
+	if (pthread_create(&dining_table->checkpoint.thread, NULL,
+			&checkpoint_routine, dining_table) != 0)
+		return (false);
+	dining_table->checkpoint.started = true;
+	return (true);
+}
+
+/* stop_checkpoints:
+ *   Waits for the checkpoint thread to return once the simulation has
+ *   stopped, if it was started.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ */
+void	stop_checkpoints(t_dining_table *dining_table)
+{
+	if (!dining_table->checkpoint.started)
+		return ;
+	pthread_join(dining_table->checkpoint.thread, NULL);
+	dining_table->checkpoint.started = false;
+}
+
+/* print_checkpoint_report:
+ *   If a checkpoint file was given, prints on the standard error how
+ *   many checkpoints were taken, how long they took to write, and how
+ *   many records had to be read again.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ */
+void	print_checkpoint_report(t_dining_table *dining_table)
+{
+	t_checkpoint	*checkpoint;
+	double			mean_us;
+
+	checkpoint = &dining_table->checkpoint;
+	if (!checkpoint->header)
+		return ;
+	mean_us = 0;
+	if (checkpoint->taken > 0)
+		mean_us = checkpoint->total_ns / 1000.0 / checkpoint->taken;
+	fprintf(stderr, "checkpoint: %lu taken, longest %.1f us (cpu %.1f us), "
+		"mean %.1f us, retries %lu\n", checkpoint->taken,
+		checkpoint->longest_ns / 1000.0, checkpoint->longest_cpu_ns / 1000.0,
+		mean_us, checkpoint->retries);
+}
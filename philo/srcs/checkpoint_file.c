@@ -0,0 +1,265 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   checkpoint_file.c                                  :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: antestem <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/07/11 17:01:48 by antestem          #+#    #+#             */
+/*   Updated: 2024/07/11 17:01:49 by antestem         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "philosophers.h"
+
+/* fill_checkpoint_header:
+ *   Writes the simulation parameters a checkpoint must be resumed with,
+ *   as open_trace does for a trace file, and marks the file as holding
+ *   no checkpoint yet.
+ *
+ *   Parameters:
+ *     - header: Pointer to the checkpoint header.
+ *     - dining_table: Pointer to the dining_table structure.
+ */
+static void	fill_checkpoint_header(t_checkpoint_header *header,
+		t_dining_table *dining_table)
+{
+	header->magic = CHECKPOINT_MAGIC;
+	header->version = CHECKPOINT_VERSION;
+	header->num_philosophers = dining_table->num_philosophers;
+	header->num_forks = dining_table->num_forks;
+	header->must_eat_count = dining_table->must_eat_count;
+	header->time_to_die = dining_table->time_to_die;
+	header->time_to_eat = dining_table->time_to_eat;
+	header->time_to_sleep = dining_table->time_to_sleep;
+	header->fork_acquisition = dining_table->settings.fork_acquisition;
+	header->current = CHECKPOINT_EMPTY;
+}
+
+/* checkpoint_size:
+ *   Returns the size of a checkpoint file: the header, then the slots,
+ *   each holding one record per philosopher.
+ *
+ *   Parameters:
+ *     - num_philosophers: The number of philosophers.
+ *
+ *   Returns:
+ *     - The size of the file, in bytes.
+ */
+static size_t	checkpoint_size(unsigned int num_philosophers)
+{
+	return (sizeof(t_checkpoint_header) + CHECKPOINT_SLOTS
+		* (sizeof(t_checkpoint_slot) + sizeof(t_checkpoint_record)
+			* num_philosophers));
+}
+
+/* checkpoint_slot:
+ *   Finds one of the slots of a mapped checkpoint file.
+ *
+ *   Parameters:
+ *     - header: Pointer to the mapped checkpoint header.
+ *     - slot: The number of the slot, below CHECKPOINT_SLOTS.
+ *
+ *   Returns:
+ *     - A pointer to the slot.
+ */
+t_checkpoint_slot	*checkpoint_slot(t_checkpoint_header *header,
+		unsigned int slot)
+{
+	return ((t_checkpoint_slot *)((char *)(header + 1) + slot
+		* (sizeof(t_checkpoint_slot) + sizeof(t_checkpoint_record)
+			* header->num_philosophers)));
+}
+
+/* copy_checkpoint:
+ *   Maps a checkpoint file for reading and, if it was taken with the
+ *   table's parameters, copies the records of its last complete
+ *   checkpoint for resume_checkpoint to apply once the simulation
+ *   starts. The file is unmapped before returning, so that the same
+ *   file can then be opened to take new checkpoints into.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ *     - fd: The open checkpoint file.
+ *
+ *   Returns:
+ *     - NULL if the records were copied, or the error message to print.
+ */
+static char	*copy_checkpoint(t_dining_table *dining_table, int fd)
+{
+	t_checkpoint_header	expected;
+	t_checkpoint_header	*header;
+	t_checkpoint_slot	*slot;
+	struct stat			file_info;
+	char				*error;
+
+	if (fstat(fd, &file_info) != 0
+		|| (size_t)file_info.st_size < sizeof(t_checkpoint_header))
+		return (ERROR_CHECKPOINT_FILE);
+	header = mmap(NULL, file_info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (header == MAP_FAILED)
+		return (ERROR_CHECKPOINT_FILE);
+	fill_checkpoint_header(&expected, dining_table);
+	error = NULL;
+	if (memcmp(&expected, header, offsetof(t_checkpoint_header, current))
+		!= 0 || (size_t)file_info.st_size
+		!= checkpoint_size(dining_table->num_philosophers))
+		error = ERROR_CHECKPOINT_MISMATCH;
+	else if (header->current >= CHECKPOINT_SLOTS)
+		error = ERROR_CHECKPOINT_EMPTY;
+	else
+	{
+		slot = checkpoint_slot(header, header->current);
+		dining_table->checkpoint.records = malloc(sizeof(t_checkpoint_record)
+				* dining_table->num_philosophers);
+		if (dining_table->checkpoint.records == NULL)
+			error = ERROR_MEMORY_ALLOCATION;
+		else
+			memcpy(dining_table->checkpoint.records, slot->records,
+				sizeof(t_checkpoint_record) * dining_table->num_philosophers);
+		dining_table->checkpoint.resumed_ms = slot->elapsed_ms;
+	}
+	munmap(header, file_info.st_size);
+	return (error);
+}
+
+/* load_checkpoint:
+ *   Reads the checkpoint to resume the simulation from. Frees the
+ *   dining table if the file cannot be read or does not match the
+ *   table's parameters.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ *     - path: The path of the checkpoint file.
+ *
+ *   Returns:
+ *     - A boolean indicating whether the checkpoint was read.
+ */
+bool	load_checkpoint(t_dining_table *dining_table, char *path)
+{
+	int		fd;
+	char	*error;
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return (print_error_and_exit(ERROR_CHECKPOINT_FILE, path,
+				dining_table));
+	error = copy_checkpoint(dining_table, fd);
+	close(fd);
+	if (error != NULL)
+		return (print_error_and_exit(error, path, dining_table));
+	return (true);
+}
+
+/* open_checkpoint:
+ *   Creates or reuses the checkpoint file and maps it into memory: like
+ *   a trace file, a checkpoint is then plain stores into the mapping,
+ *   which the kernel writes back in the background and keeps if the
+ *   process crashes. When the run resumes from this same file, its last
+ *   checkpoint is kept until a new one is complete. Frees the dining
+ *   table if the file cannot be used.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ *     - path: The path of the checkpoint file.
+ *
+ *   Returns:
+ *     - A boolean indicating whether the checkpoint file is ready.
+ */
+bool	open_checkpoint(t_dining_table *dining_table, char *path)
+{
+	t_checkpoint	*checkpoint;
+	void			*mapping;
+
+	checkpoint = &dining_table->checkpoint;
+	checkpoint->size = checkpoint_size(dining_table->num_philosophers);
+	checkpoint->fd = open(path, O_RDWR | O_CREAT, 0644);
+	if (checkpoint->fd < 0 || ftruncate(checkpoint->fd, checkpoint->size) != 0)
+		return (print_error_and_exit(ERROR_CHECKPOINT_FILE, path,
+				dining_table));
+	mapping = mmap(NULL, checkpoint->size, PROT_READ | PROT_WRITE,
+			MAP_SHARED, checkpoint->fd, 0);
+	if (mapping == MAP_FAILED)
+		return (print_error_and_exit(ERROR_CHECKPOINT_FILE, path,
+				dining_table));
+	checkpoint->header = mapping;
+	if (!dining_table->settings.resume
+		|| strcmp(dining_table->settings.resume, path) != 0)
+		fill_checkpoint_header(checkpoint->header, dining_table);
+	return (true);
+}
+
+/* resume_philosopher:
+ *   Gives a philosopher the state he had in a checkpoint, with his
+ *   times moved from the moment he was checkpointed to the start of the
+ *   resumed simulation: he is as hungry, and his meal or nap has as long
+ *   left to last, as when the checkpoint was taken.
+ *
+ *   Parameters:
+ *     - philosopher: Pointer to the philosopher structure.
+ *     - record: Pointer to his record in the checkpoint.
+ *     - start_time: The start time of the resumed simulation.
+ */
+static void	resume_philosopher(t_philosopher *philosopher,
+		t_checkpoint_record *record, time_t start_time)
+{
+	philosopher->times_ate = record->times_ate;
+	philosopher->last_meal_time = start_time - record->hunger_ms;
+	philosopher->longest_hunger = record->longest_hunger_ms;
+	philosopher->jitter_seed = record->jitter_seed;
+	philosopher->backoff_seed = record->backoff_seed;
+	philosopher->noise_seed = record->noise_seed;
+	record_phase(philosopher, record->phase,
+		start_time + record->phase_left_ms);
+}
+
+/* resume_checkpoint:
+ *   Once the start time is set and before any philosopher starts, gives
+ *   every philosopher his state from the checkpoint read by
+ *   load_checkpoint, then frees its records. The philosophers then pick
+ *   their routines back up where the checkpoint left them (see
+ *   philosopher_routine).
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ */
+void	resume_checkpoint(t_dining_table *dining_table)
+{
+	t_checkpoint	*checkpoint;
+	unsigned int	i;
+
+	checkpoint = &dining_table->checkpoint;
+	if (checkpoint->records == NULL)
+		return ;
+	i = 0;
+	while (i < dining_table->num_philosophers)
+	{
+		resume_philosopher(dining_table->philosophers[i],
+			&checkpoint->records[i], dining_table->start_time);
+		i++;
+	}
+	free(checkpoint->records);
+	checkpoint->records = NULL;
+	checkpoint->resumed = true;
+	fprintf(stderr, "checkpoint: resumed at %lu ms\n",
+		(unsigned long)checkpoint->resumed_ms);
+}
+
+/* close_checkpoint:
+ *   Unmaps and closes the checkpoint file, and frees the records of a
+ *   checkpoint that was read but never resumed.
+ *
+ *   Parameters:
+ *     - checkpoint: Pointer to the checkpoint structure.
+ */
+void	close_checkpoint(t_checkpoint *checkpoint)
+{
+	if (checkpoint->header)
+		munmap(checkpoint->header, checkpoint->size);
+	if (checkpoint->fd >= 0)
+		close(checkpoint->fd);
+	free(checkpoint->records);
+	checkpoint->header = NULL;
+	checkpoint->fd = -1;
+	checkpoint->records = NULL;
+}
@@ -0,0 +1,120 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   class_report.c                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: antestem <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/07/11 17:01:42 by antestem          #+#    #+#             */
+/*   Updated: 2024/07/11 17:01:43 by antestem         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "philosophers.h"
+
+/* sum_class:
+ *   Sums the meals, the longest hunger, the smallest margin left before
+ *   time_to_die and the deaths of the philosophers of one class. A
+ *   philosopher who died went at least his time_to_die without eating.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ *     - class: The number of the class.
+ *     - stats: Where to store the totals.
+ */
+static void	sum_class(t_dining_table *dining_table, unsigned int class,
+		t_class_stats *stats)
+{
+	t_philosopher	*philosopher;
+	time_t			hunger;
+	unsigned int	i;
+
+	memset(stats, 0, sizeof(t_class_stats));
+	i = 0;
+	while (i < dining_table->num_philosophers)
+	{
+		philosopher = dining_table->philosophers[i++];
+		if (philosopher->timing_class != class)
+			continue ;
+		if (stats->count++ == 0)
+		{
+			stats->first = philosopher;
+			stats->min_slack = philosopher->time_to_die;
+		}
+		stats->meals += philosopher->times_ate;
+		stats->meals_squared += (double)philosopher->times_ate
+			* philosopher->times_ate;
+		hunger = philosopher->longest_hunger;
+		if (philosopher->died && hunger < philosopher->time_to_die)
+			hunger = philosopher->time_to_die;
+		if (hunger > stats->worst_hunger)
+			stats->worst_hunger = hunger;
+		if (philosopher->time_to_die - hunger < stats->min_slack)
+			stats->min_slack = philosopher->time_to_die - hunger;
+		stats->deaths += philosopher->died;
+	}
+}
+
+/* print_class_row:
+ *   Prints one row of the class report: the class's timings, its meal
+ *   rate per philosopher, how evenly the meals were shared within the
+ *   class (Jain's index: 1 when everyone ate as often, 1/n when one
+ *   philosopher had all the meals), the longest anyone went without
+ *   eating, the smallest margin anyone had left before time_to_die,
+ *   and the deaths.
+ *
+ *   Parameters:
+ *     - class: The number of the class.
+ *     - stats: The totals of the class.
+ *     - elapsed: The duration of the run, in milliseconds.
+ */
+static void	print_class_row(unsigned int class, t_class_stats *stats,
+		time_t elapsed)
+{
+	char	timings[48];
+	double	fairness;
+
+	snprintf(timings, sizeof(timings), "%ld/%ld/%ld+%u",
+		stats->first->time_to_die, stats->first->time_to_eat,
+		stats->first->time_to_sleep, stats->first->jitter_ms);
+	fairness = 1;
+	if (stats->meals_squared > 0)
+		fairness = (double)stats->meals * stats->meals
+			/ (stats->count * stats->meals_squared);
+	if (elapsed < 1)
+		elapsed = 1;
+	fprintf(stderr, "classes: %5u %6u %-18s %8lu %13.2f %8.3f %13ld "
+		"%12ld %6u\n", class, stats->count, timings, stats->meals,
+		stats->meals * 1000.0 / elapsed / stats->count, fairness,
+		stats->worst_hunger, stats->min_slack, stats->deaths);
+}
+
+/* print_class_report:
+ *   Prints on the standard error the throughput and fairness of each
+ *   timing class with the "classes" profile.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure, whose
+ *       philosopher threads have all been joined.
+ */
+void	print_class_report(t_dining_table *dining_table)
+{
+	t_class_stats	stats;
+	time_t			elapsed;
+	unsigned int	class;
+
+	if (dining_table->settings.profile != PROFILE_CLASSES)
+		return ;
+	elapsed = get_current_time_in_ms() - dining_table->start_time;
+	fprintf(stderr, "classes: %5s %6s %-18s %8s %13s %8s %13s %12s %6s\n",
+		"class", "philos", "die/eat/sleep+jit", "meals", "meals/s/philo",
+		"fairness", "worst_hunger", "min_slack", "deaths");
+	class = 0;
+	while (class < dining_table->num_classes)
+	{
+		sum_class(dining_table, class, &stats);
+		if (stats.count > 0)
+			print_class_row(class, &stats, elapsed);
+		class++;
+	}
+}
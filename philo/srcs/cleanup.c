@@ -22,9 +22,14 @@
 *     which contains all allocated resources.
 *   
 *   This function first checks if the dining_table is NULL.
-*   If not, it frees the fork locks, then iterates over 
-*   the philosophers array and frees each philosopher. 
-*   Finally, it frees the dining_table itself.
+*   If not, it closes the trace and checkpoint files, frees the settings,
+*   the output rings,
+*   the seatings of the membership churn and the fork locks, then iterates
+*   over the whole philosophers array and frees each philosopher along
+*   with their resource set. 
+*   Then it unmaps the stacks of the "low" footprint mode. Finally, it
+*   frees the dining_table itself, or unmaps the arena it lives in when
+*   the philosophers ran in worker processes or the footprint is "low".
 */
 void	*free_dining_table(t_dining_table *dining_table)
 {
@@ -32,20 +37,36 @@ void	*free_dining_table(t_dining_table *dining_table)
 
 	if (!dining_table)
 		return (NULL);
+	close_trace(&dining_table->trace);
+	close_checkpoint(&dining_table->checkpoint);
+	free_settings(&dining_table->settings);
+	free_output(dining_table);
+	free_membership(dining_table);
 	if (dining_table->fork_locks != NULL)
-		free(dining_table->fork_locks);
+		table_free(dining_table, dining_table->fork_locks);
 	if (dining_table->philosophers != NULL)
 	{
 		i = 0;
-		while (i < dining_table->num_philosophers)
+		while (i < dining_table->capacity)
 		{
 			if (dining_table->philosophers[i] != NULL)
-				free(dining_table->philosophers[i]);
+			{
+				table_free(dining_table,
+					dining_table->philosophers[i]->forks);
+				table_free(dining_table,
+					dining_table->philosophers[i]->fork_nodes);
+			}
+			table_free(dining_table, dining_table->philosophers[i]);
 			i++;
 		}
-		free(dining_table->philosophers);
+		table_free(dining_table, dining_table->philosophers);
 	}
-	free(dining_table);
+	free(dining_table->workers);
+	free_thread_stacks(dining_table);
+	if (dining_table->arena)
+		munmap(dining_table->arena, dining_table->arena->size);
+	else
+		free(dining_table);
 	return (NULL);
 }
 
@@ -57,8 +78,8 @@ void	*free_dining_table(t_dining_table *dining_table)
 *   - dining_table: Pointer to the dining table structure 
 *     which contains the mutexes.
 *   
-*   This function iterates over all philosophers, destroying 
-*   their fork locks and last meal locks. Then it destroys 
+*   This function destroys every fork lock, then iterates over 
+*   all philosophers, destroying their last meal locks. Then it destroys 
 *   the write lock and the simulation stop lock.
 */
 void	destroy_all_mutexes(t_dining_table *dining_table)
@@ -66,9 +87,11 @@ void	destroy_all_mutexes(t_dining_table *dining_table)
 	unsigned int	i;
 
 	i = 0;
-	while (i < dining_table->num_philosophers)
+	while (i < dining_table->num_forks)
+		fork_lock_destroy(&dining_table->fork_locks[i++]);
+	i = 0;
+	while (i < dining_table->capacity)
 	{
-		pthread_mutex_destroy(&dining_table->fork_locks[i]);
 		pthread_mutex_destroy(&dining_table->philosophers[i]->last_meal_lock);
 		i++;
 	}
@@ -107,15 +130,17 @@ int	print_message(char *message, char *detail, int exit_code)
 *   - details: Additional detail to be included in the error message.
 *   - dining_table: Pointer to the dining table structure to be freed.
 *   
-*   This function frees the dining table using free_dining_table
-*   and prints an error message using print_message, then returns 0.
+*   This function prints an error message using print_message, then
+*   frees the dining table using free_dining_table, since the details
+*   may belong to the table's settings, and returns 0.
 */
 int	print_error_and_exit(char *message, char *details, \
 t_dining_table *dining_table)
 {
+	print_message(message, details, 0);
 	if (dining_table != NULL)
 		free_dining_table(dining_table);
-	return (print_message(message, details, 0));
+	return (0);
 }
 
 /* print_error_and_return_null:
@@ -128,14 +153,14 @@ t_dining_table *dining_table)
 *   - details: Additional detail to be included in the error message.
 *   - dining_table: Pointer to the dining table structure to be freed.
 *   
-*   This function frees the dining table using free_dining_table
-*   and prints an error message using print_message, then returns NULL.
+*   This function prints an error message using print_message, then
+*   frees the dining table using free_dining_table and returns NULL.
 */
 void	*print_error_and_return_null(char *message, \
 char *details, t_dining_table *dining_table)
 {
+	print_message(message, details, EXIT_FAILURE);
 	if (dining_table != NULL)
 		free_dining_table(dining_table);
-	print_message(message, details, EXIT_FAILURE);
 	return (NULL);
 }
@@ -0,0 +1,176 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   fork_acquisition.c                                 :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: antestem <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/07/11 16:58:25 by antestem          #+#    #+#             */
+/*   Updated: 2024/07/11 16:58:26 by antestem         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "philosophers.h"
+
+/* try_take_all_forks:
+ *   Tries to lock every fork in the philosopher's resource set without
+ *   waiting. If one of them is in use, the forks taken so far are put
+ *   back down so that they stay available to the neighbors.
+ *
+ *   Parameters:
+ *     - philosopher: Pointer to the philosopher structure.
+ *
+ *   Returns:
+ *     - A boolean indicating whether all forks are now held.
+ */
+static bool	try_take_all_forks(t_philosopher *philosopher)
+{
+	philosopher->forks_held = 0;
+	while (philosopher->forks_held < philosopher->num_forks)
+	{
+		NOISE_POINT(philosopher->dining_table, &philosopher->noise_seed);
+		if (!fork_lock_try_acquire(&philosopher->dining_table->\
+		fork_locks[philosopher->forks[philosopher->forks_held]],
+			&philosopher->fork_nodes[philosopher->forks_held]))
+		{
+			release_forks(philosopher);
+			return (false);
+		}
+		philosopher->forks_held++;
+	}
+	return (true);
+}
+
+/* random_jitter:
+ *   Returns a pseudo-random number between 0 and max, drawn from the
+ *   philosopher's own xorshift state so that neighbors who failed
+ *   together do not retry in lockstep.
+ *
+ *   Parameters:
+ *     - philosopher: Pointer to the philosopher structure.
+ *     - max: The largest value to return.
+ *
+ *   Returns:
+ *     - A number between 0 and max.
+ */
+static time_t	random_jitter(t_philosopher *philosopher, time_t max)
+{
+	philosopher->backoff_seed ^= philosopher->backoff_seed << 13;
+	philosopher->backoff_seed ^= philosopher->backoff_seed >> 17;
+	philosopher->backoff_seed ^= philosopher->backoff_seed << 5;
+	return (philosopher->backoff_seed % (max + 1));
+}
+
+/* take_forks_with_backoff:
+ *   Tries to take all forks at once, and retries after a randomized,
+ *   exponentially growing pause while any of them is in use, counting
+ *   each failed try in fork_waits. The pause
+ *   starts at BACKOFF_MIN_US and is capped at a fraction of his time_to_eat,
+ *   since a neighbor's meal is the longest a fork can stay taken.
+ *   The "has taken a fork" messages are only printed once every fork is
+ *   held, so that forks put back down after a failed try never appear
+ *   in the output. For the same reason, the whole wait counts as waiting
+ *   for the first fork in the "states" profile.
+ *
+ *   Parameters:
+ *     - philosopher: Pointer to the philosopher structure.
+ *
+ *   Returns:
+ *     - A boolean indicating whether the forks were taken before the
+ *       simulation stopped.
+ */
+static bool	take_forks_with_backoff(t_philosopher *philosopher)
+{
+	time_t	backoff;
+	time_t	max_backoff;
+
+	backoff = BACKOFF_MIN_US;
+	max_backoff = PHILO_TIME_TO_EAT(philosopher) * 1000
+		/ BACKOFF_EAT_DIVISOR;
+	profile_transition(philosopher, STATE_FIRST_FORK);
+	if (max_backoff > 1000000)
+		max_backoff = 1000000;
+	while (!try_take_all_forks(philosopher))
+	{
+		atomic_fetch_add_explicit(&philosopher->fork_waits, 1,
+			memory_order_relaxed);
+		if (is_simulation_stopped(philosopher->dining_table))
+			return (false);
+		usleep(backoff / 2 + random_jitter(philosopher, backoff / 2));
+		if (backoff * 2 <= max_backoff)
+			backoff *= 2;
+	}
+	philosopher->forks_held = 0;
+	while (philosopher->forks_held < philosopher->num_forks)
+	{
+		trace_after(philosopher, TRACE_FORK, philosopher->forks_held++);
+		philo_stat(philosopher, false, PHILO_GOT_FORK);
+	}
+	return (true);
+}
+
+/* take_forks:
+ *   Takes every fork the philosopher needs to eat, according to the
+ *   table's fork acquisition mode. In the default blocking mode, forks
+ *   are taken one at a time in the order decided at initialization,
+ *   waiting for each fork lock while holding the previous ones. When
+ *   replaying a trace, forks are always taken this way, in the recorded
+ *   order. Each fork is first tried without waiting, so that the forks
+ *   found in use can be counted in fork_waits.
+ *
+ *   Parameters:
+ *     - philosopher: Pointer to the philosopher structure.
+ *
+ *   Returns:
+ *     - A boolean indicating whether the philosopher holds his forks.
+ */
+bool	take_forks(t_philosopher *philosopher)
+{
+	if (philosopher->dining_table->settings.fork_acquisition
+		== FORK_BACKOFF
+		&& philosopher->dining_table->trace.mode != TRACE_REPLAY)
+		return (take_forks_with_backoff(philosopher));
+	philosopher->forks_held = 0;
+	while (philosopher->forks_held < philosopher->num_forks)
+	{
+		if (philosopher->forks_held == 0)
+			profile_transition(philosopher, STATE_FIRST_FORK);
+		else
+			profile_transition(philosopher, STATE_OTHER_FORKS);
+		trace_before(philosopher, TRACE_FORK, philosopher->forks_held);
+		NOISE_POINT(philosopher->dining_table, &philosopher->noise_seed);
+		if (!fork_lock_try_acquire(&philosopher->dining_table->\
+		fork_locks[philosopher->forks[philosopher->forks_held]],
+			&philosopher->fork_nodes[philosopher->forks_held]))
+		{
+			atomic_fetch_add_explicit(&philosopher->fork_waits, 1,
+				memory_order_relaxed);
+			fork_lock_acquire(&philosopher->dining_table->\
+			fork_locks[philosopher->forks[philosopher->forks_held]],
+				&philosopher->fork_nodes[philosopher->forks_held]);
+		}
+		NOISE_POINT(philosopher->dining_table, &philosopher->noise_seed);
+		trace_after(philosopher, TRACE_FORK, philosopher->forks_held++);
+		philo_stat(philosopher, false, PHILO_GOT_FORK);
+	}
+	return (true);
+}
+
+/* release_forks:
+ *   Puts down every fork the philosopher holds, in the reverse order
+ *   of how they were taken.
+ *
+ *   Parameters:
+ *     - philosopher: Pointer to the philosopher structure.
+ */
+void	release_forks(t_philosopher *philosopher)
+{
+	while (philosopher->forks_held > 0)
+	{
+		philosopher->forks_held--;
+		NOISE_POINT(philosopher->dining_table, &philosopher->noise_seed);
+		fork_lock_release(&philosopher->dining_table->\
+		fork_locks[philosopher->forks[philosopher->forks_held]],
+			&philosopher->fork_nodes[philosopher->forks_held]);
+	}
+}
@@ -0,0 +1,130 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   fork_lock_mcs.c                                    :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: antestem <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/07/11 16:58:49 by antestem          #+#    #+#             */
+/*   Updated: 2024/07/11 16:58:50 by antestem         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "philosophers.h"
+
+#if FORK_LOCK == FORK_LOCK_MCS
+
+/* fork_lock_init:
+ *   Initializes an MCS queue lock. Waiting philosophers queue up behind
+ *   the fork's tail, and each one spins on a flag in its own queue node
+ *   instead of on the shared lock, so a handoff only touches the cache
+ *   line of the next philosopher in line.
+ *
+ *   Parameters:
+ *     - lock: Pointer to the fork lock to initialize.
+ *     - shared: Whether the lock is shared with other processes, which
+ *       needs nothing more from a lock made of atomics.
+ *
+ *   Returns:
+ *     - Always true.
+ */
+bool	fork_lock_init(t_fork_lock *lock, bool shared)
+{
+	(void)shared;
+	atomic_init(&lock->tail, NULL);
+	return (true);
+}
+
+/* fork_lock_destroy:
+ *   An MCS lock holds no resources, so there is nothing to do.
+ *
+ *   Parameters:
+ *     - lock: Pointer to the fork lock to destroy.
+ */
+void	fork_lock_destroy(t_fork_lock *lock)
+{
+	(void)lock;
+}
+
+/* fork_lock_acquire:
+ *   Appends the philosopher's node to the fork's queue. If someone was
+ *   already queued, links the node behind them and spins until they hand
+ *   the fork over, yielding the CPU after SPIN_LIMIT checks.
+ *
+ *   Parameters:
+ *     - lock: Pointer to the fork lock.
+ *     - node: Pointer to the philosopher's queue node for this fork.
+ */
+void	fork_lock_acquire(t_fork_lock *lock, t_fork_node *node)
+{
+	t_fork_node		*predecessor;
+	unsigned int	spins;
+
+	atomic_store_explicit(&node->next, NULL, memory_order_relaxed);
+	atomic_store_explicit(&node->waiting, true, memory_order_relaxed);
+	predecessor = atomic_exchange_explicit(&lock->tail, node,
+			memory_order_acq_rel);
+	if (predecessor == NULL)
+		return ;
+	atomic_store_explicit(&predecessor->next, node, memory_order_release);
+	spins = 0;
+	while (atomic_load_explicit(&node->waiting, memory_order_acquire))
+	{
+		CPU_RELAX();
+		if (++spins > SPIN_LIMIT)
+			sched_yield();
+	}
+}
+
+/* fork_lock_try_acquire:
+ *   Locks the fork only if nobody holds it or is queued for it.
+ *
+ *   Parameters:
+ *     - lock: Pointer to the fork lock.
+ *     - node: Pointer to the philosopher's queue node for this fork.
+ *
+ *   Returns:
+ *     - A boolean indicating whether the fork was locked.
+ */
+bool	fork_lock_try_acquire(t_fork_lock *lock, t_fork_node *node)
+{
+	t_fork_node	*expected;
+
+	expected = NULL;
+	atomic_store_explicit(&node->next, NULL, memory_order_relaxed);
+	return (atomic_compare_exchange_strong_explicit(&lock->tail, &expected,
+			node, memory_order_acq_rel, memory_order_relaxed));
+}
+
+/* fork_lock_release:
+ *   Hands the fork to the next philosopher in the queue. If nobody is
+ *   queued, empties the queue; if someone is joining at that very
+ *   moment, waits for them to link their node first.
+ *
+ *   Parameters:
+ *     - lock: Pointer to the fork lock.
+ *     - node: Pointer to the philosopher's queue node for this fork.
+ */
+void	fork_lock_release(t_fork_lock *lock, t_fork_node *node)
+{
+	t_fork_node	*successor;
+	t_fork_node	*expected;
+
+	successor = atomic_load_explicit(&node->next, memory_order_acquire);
+	if (successor == NULL)
+	{
+		expected = node;
+		if (atomic_compare_exchange_strong_explicit(&lock->tail, &expected,
+				NULL, memory_order_release, memory_order_relaxed))
+			return ;
+		while (successor == NULL)
+		{
+			CPU_RELAX();
+			successor = atomic_load_explicit(&node->next,
+					memory_order_acquire);
+		}
+	}
+	atomic_store_explicit(&successor->waiting, false, memory_order_release);
+}
+
+#endif
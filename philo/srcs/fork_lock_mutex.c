@@ -0,0 +1,100 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   fork_lock_mutex.c                                  :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: antestem <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/07/11 16:58:33 by antestem          #+#    #+#             */
+/*   Updated: 2024/07/11 16:58:34 by antestem         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "philosophers.h"
+
+#if FORK_LOCK == FORK_LOCK_MUTEX || FORK_LOCK == FORK_LOCK_ADAPTIVE
+
+/* fork_lock_init:
+ *   Initializes a fork lock backed by a pthread mutex. When built with
+ *   FORK_LOCK=adaptive, the mutex spins for a short while before
+ *   sleeping in the kernel, which suits the predictable handoffs at the
+ *   end of each meal.
+ *
+ *   Parameters:
+ *     - lock: Pointer to the fork lock to initialize.
+ *     - shared: Whether the lock is shared with other processes.
+ *
+ *   Returns:
+ *     - A boolean indicating whether the mutex was created.
+ */
+bool	fork_lock_init(t_fork_lock *lock, bool shared)
+{
+	pthread_mutexattr_t	attributes;
+	bool				success;
+
+	if (pthread_mutexattr_init(&attributes) != 0)
+		return (false);
+	if (FORK_LOCK == FORK_LOCK_ADAPTIVE)
+		pthread_mutexattr_settype(&attributes, PTHREAD_MUTEX_ADAPTIVE_NP);
+	if (shared)
+		pthread_mutexattr_setpshared(&attributes, PTHREAD_PROCESS_SHARED);
+	success = (pthread_mutex_init(&lock->mutex, &attributes) == 0);
+	pthread_mutexattr_destroy(&attributes);
+	return (success);
+}
+
+/* fork_lock_destroy:
+ *   Destroys a fork lock's mutex.
+ *
+ *   Parameters:
+ *     - lock: Pointer to the fork lock to destroy.
+ */
+void	fork_lock_destroy(t_fork_lock *lock)
+{
+	pthread_mutex_destroy(&lock->mutex);
+}
+
+/* fork_lock_acquire:
+ *   Locks a fork, waiting for it to be released if it is in use.
+ *   The queue node is only used by the MCS lock.
+ *
+ *   Parameters:
+ *     - lock: Pointer to the fork lock.
+ *     - node: Pointer to the philosopher's queue node for this fork.
+ */
+void	fork_lock_acquire(t_fork_lock *lock, t_fork_node *node)
+{
+	(void)node;
+	pthread_mutex_lock(&lock->mutex);
+}
+
+/* fork_lock_try_acquire:
+ *   Locks a fork only if it is free.
+ *
+ *   Parameters:
+ *     - lock: Pointer to the fork lock.
+ *     - node: Pointer to the philosopher's queue node for this fork.
+ *
+ *   Returns:
+ *     - A boolean indicating whether the fork was locked.
+ */
+bool	fork_lock_try_acquire(t_fork_lock *lock, t_fork_node *node)
+{
+	(void)node;
+	return (pthread_mutex_trylock(&lock->mutex) == 0);
+}
+
+/* fork_lock_release:
+ *   Unlocks a fork.
+ *
+ *   Parameters:
+ *     - lock: Pointer to the fork lock.
+ *     - node: Pointer to the philosopher's queue node for this fork.
+ */
+void	fork_lock_release(t_fork_lock *lock, t_fork_node *node)
+{
+	(void)node;
+	pthread_mutex_unlock(&lock->mutex);
+}
+
+#endif
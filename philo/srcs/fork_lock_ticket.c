@@ -0,0 +1,113 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   fork_lock_ticket.c                                 :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: antestem <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/07/11 16:58:41 by antestem          #+#    #+#             */
+/*   Updated: 2024/07/11 16:58:42 by antestem         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "philosophers.h"
+
+#if FORK_LOCK == FORK_LOCK_TICKET
+
+/* fork_lock_init:
+ *   Initializes a ticket spinlock. Philosophers take a ticket and wait
+ *   for their number to be served, so a contended fork is handed over
+ *   in arrival order without ever entering the kernel.
+ *
+ *   Parameters:
+ *     - lock: Pointer to the fork lock to initialize.
+ *     - shared: Whether the lock is shared with other processes, which
+ *       needs nothing more from a lock made of atomics.
+ *
+ *   Returns:
+ *     - Always true.
+ */
+bool	fork_lock_init(t_fork_lock *lock, bool shared)
+{
+	(void)shared;
+	atomic_init(&lock->next_ticket, 0);
+	atomic_init(&lock->now_serving, 0);
+	return (true);
+}
+
+/* fork_lock_destroy:
+ *   A ticket spinlock holds no resources, so there is nothing to do.
+ *
+ *   Parameters:
+ *     - lock: Pointer to the fork lock to destroy.
+ */
+void	fork_lock_destroy(t_fork_lock *lock)
+{
+	(void)lock;
+}
+
+/* fork_lock_acquire:
+ *   Takes a ticket and spins until it is served, pausing the CPU between
+ *   checks. After SPIN_LIMIT checks, the thread also yields the CPU on
+ *   each check so that it does not starve the fork's holder when there
+ *   are more threads than cores.
+ *
+ *   Parameters:
+ *     - lock: Pointer to the fork lock.
+ *     - node: Unused by the ticket lock.
+ */
+void	fork_lock_acquire(t_fork_lock *lock, t_fork_node *node)
+{
+	unsigned int	ticket;
+	unsigned int	spins;
+
+	(void)node;
+	ticket = atomic_fetch_add_explicit(&lock->next_ticket, 1,
+			memory_order_relaxed);
+	spins = 0;
+	while (atomic_load_explicit(&lock->now_serving, memory_order_acquire)
+		!= ticket)
+	{
+		CPU_RELAX();
+		if (++spins > SPIN_LIMIT)
+			sched_yield();
+	}
+}
+
+/* fork_lock_try_acquire:
+ *   Takes a ticket only if it would be served right away.
+ *
+ *   Parameters:
+ *     - lock: Pointer to the fork lock.
+ *     - node: Unused by the ticket lock.
+ *
+ *   Returns:
+ *     - A boolean indicating whether the fork was locked.
+ */
+bool	fork_lock_try_acquire(t_fork_lock *lock, t_fork_node *node)
+{
+	unsigned int	serving;
+
+	(void)node;
+	serving = atomic_load_explicit(&lock->now_serving, memory_order_relaxed);
+	return (atomic_compare_exchange_strong_explicit(&lock->next_ticket,
+			&serving, serving + 1, memory_order_acquire,
+			memory_order_relaxed));
+}
+
+/* fork_lock_release:
+ *   Serves the next ticket. Only the holder writes now_serving.
+ *
+ *   Parameters:
+ *     - lock: Pointer to the fork lock.
+ *     - node: Unused by the ticket lock.
+ */
+void	fork_lock_release(t_fork_lock *lock, t_fork_node *node)
+{
+	(void)node;
+	atomic_store_explicit(&lock->now_serving,
+		atomic_load_explicit(&lock->now_serving, memory_order_relaxed) + 1,
+		memory_order_release);
+}
+
+#endif
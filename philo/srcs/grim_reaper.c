@@ -17,8 +17,9 @@
  *   This flag is used to signal that the simulation should stop,
  *   for example, when a philosopher dies or all philosophers 
  *   have eaten enough. Only the grim reaper thread can set this 
- *   flag to ensure proper synchronization. The flag is protected 
- *   by a mutex to ensure thread safety.
+ *   flag to ensure proper synchronization, except when starting the
+ *   worker processes fails or when a signal stops the run. The flag is
+ *   protected by a mutex to ensure thread safety.
  *   
  *   Parameters:
  *     - dining_table: Pointer to the dining_table structure 
@@ -26,7 +27,7 @@
  *     - state: Boolean value to set the simulation stop flag to 
  *       (true to stop, false to continue).
  */
-static void	set_simulation_stop_flag(t_dining_table *dining_table, bool state)
+void	set_simulation_stop_flag(t_dining_table *dining_table, bool state)
 {
 	pthread_mutex_lock(&dining_table->simulation_stop_lock);
 	dining_table->simulation_stopped = state;
@@ -63,11 +64,13 @@ bool	is_simulation_stopped(t_dining_table *dining_table)
 
 /* check_if_philosopher_should_die:
  *   Checks if a philosopher should be killed based on the 
- *   time since their last meal and the time_to_die parameter.
+ *   time since their last meal and their own time_to_die.
  *   If the time since the last meal exceeds the time_to_die, 
  *   the simulation stop flag is set, the philosopher's death is 
- *   recorded, and the function returns true. If the philosopher 
- *   should not die yet, the function returns false.
+ *   recorded, and the function returns true. The caller holds the
+ *   philosopher's last meal lock. If the philosopher 
+ *   should not die yet, the function returns false. While a trace
+ *   is being replayed, deaths come from the trace instead.
  *   
  *   Parameters:
  *     - philosopher: Pointer to the philosopher structure to check.
@@ -79,22 +82,51 @@ static bool	check_if_philosopher_should_die(t_philosopher *philosopher)
 {
 	time_t	current_time;
 
+	if (philosopher->dining_table->trace.mode == TRACE_REPLAY
+		&& !atomic_load(&philosopher->dining_table->trace.diverged))
+		return (false);
 	current_time = get_current_time_in_ms();
 	if ((current_time - philosopher->last_meal_time) >= \
-	philosopher->dining_table->time_to_die)
+	PHILO_TIME_TO_DIE(philosopher))
 	{
+		philosopher->died = true;
 		set_simulation_stop_flag(philosopher->dining_table, true);
+		trace_after(philosopher, TRACE_DIED, 0);
 		philo_stat(philosopher, true, PHILO_DIED);
-		pthread_mutex_unlock(&philosopher->last_meal_lock);
 		return (true);
 	}
 	return (false);
 }
 
+/* check_replayed_death:
+ *   While a trace is being replayed, kills the philosopher who died in
+ *   the recorded run once the replay reaches that point of the trace.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ *
+ *   Returns:
+ *     - A boolean indicating whether a philosopher has died.
+ */
+static bool	check_replayed_death(t_dining_table *dining_table)
+{
+	t_philosopher	*philosopher;
+
+	philosopher = trace_next_death(dining_table);
+	if (philosopher == NULL)
+		return (false);
+	set_simulation_stop_flag(dining_table, true);
+	philosopher->died = true;
+	philo_stat(philosopher, true, PHILO_DIED);
+	return (true);
+}
+
 /* check_end_conditions:
  *   Checks each philosopher to see if one of two end conditions
  *   has been reached. Stops the simulation if a philosopher needs
- *   to be killed, or if every philosopher has eaten enough.
+ *   to be killed, or if every philosopher has eaten enough. With
+ *   membership churn, only the philosophers of the current seating are
+ *   checked, without holding back the changes to it (see enter_seating).
  *   
  *   Returns true if an end condition has been reached, false if not.
  *   
@@ -107,24 +139,38 @@ static bool	check_if_philosopher_should_die(t_philosopher *philosopher)
  */
 static bool	check_end_conditions(t_dining_table *dining_table)
 {
+	t_seating		*seating;
+	t_philosopher	*philosopher;
+	unsigned int	count;
 	unsigned int	i;
 	bool			all_philosophers_ate_enough;
+	bool			died;
 
+	if (check_replayed_death(dining_table))
+		return (true);
 	all_philosophers_ate_enough = true;
+	seating = enter_seating(dining_table, READER_REAPER);
+	count = TABLE_PHILOSOPHERS(dining_table);
+	if (seating != NULL)
+		count = seating->count;
+	died = false;
 	i = 0;
-	while (i < dining_table->num_philosophers)
+	while (i < count && !died)
 	{
-		pthread_mutex_lock(&dining_table->philosophers[i]->last_meal_lock);
-		if (check_if_philosopher_should_die(dining_table->philosophers[i]))
-			return (true);
-		if (dining_table->must_eat_count != -1)
-			if (dining_table->philosophers[i]->\
-			times_ate < (unsigned int)dining_table->must_eat_count)
+		NOISE_POINT(dining_table, &dining_table->noise_seed);
+		philosopher = seated_philosopher(dining_table, seating, i++);
+		pthread_mutex_lock(&philosopher->last_meal_lock);
+		died = check_if_philosopher_should_die(philosopher);
+		if (TABLE_MUST_EAT(dining_table) != -1)
+			if (philosopher->times_ate
+				< (unsigned int)TABLE_MUST_EAT(dining_table))
 				all_philosophers_ate_enough = false;
-		pthread_mutex_unlock(&dining_table->philosophers[i]->last_meal_lock);
-		i++;
+		pthread_mutex_unlock(&philosopher->last_meal_lock);
 	}
-	if (dining_table->must_eat_count != -1
+	leave_seating(dining_table, READER_REAPER);
+	if (died)
+		return (true);
+	if (TABLE_MUST_EAT(dining_table) != -1
 		&& all_philosophers_ate_enough == true)
 	{
 		set_simulation_stop_flag(dining_table, true);
@@ -136,7 +182,10 @@ static bool	check_end_conditions(t_dining_table *dining_table)
 /* grim_reaper_routine:
  *   The grim reaper thread's routine. Checks if a philosopher must
  *   be killed and if all philosophers ate enough. If one of those two
- *   end conditions are reached, it stops the simulation.
+ *   end conditions are reached, it stops the simulation. It also
+ *   returns once the simulation was stopped by a signal. In the
+ *   real-time mode, it runs above every philosopher once the
+ *   simulation starts, so that a busy host does not delay a death.
  *   
  *   Parameters:
  *     - data: Pointer to the dining_table structure containing 
@@ -150,15 +199,15 @@ void	*grim_reaper_routine(void *data)
 	t_dining_table	*dining_table;
 
 	dining_table = (t_dining_table *)data;
-	if (dining_table->must_eat_count == 0)
+	if (TABLE_MUST_EAT(dining_table) == 0)
 		return (NULL);
-	set_simulation_stop_flag(dining_table, false);
 	delay_simulation_start(dining_table->start_time);
-	while (true)
+	set_realtime_priority(dining_table, REALTIME_LEVELS);
+	while (!is_simulation_stopped(dining_table))
 	{
 		if (check_end_conditions(dining_table) == true)
 			return (NULL);
-		usleep(1000);
+		usleep(dining_table->settings.reaper_interval_us);
 	}
 	return (NULL);
 }
@@ -67,10 +67,59 @@ int	parse_integer(char *str)
 	return ((int)nb);
 }
 
+/* parse_unsigned:
+ *   Converts a digit-only string into an integer between 0 and INT_MAX.
+ *
+ *   Parameters:
+ *     - str: The string to be converted.
+ *     - value: Where to store the converted number.
+ *
+ *   Returns:
+ *     - A boolean indicating whether the string was a valid number.
+ */
+bool	parse_unsigned(char *str, int *value)
+{
+	if (!str[0] || !contains_only_digits(str) || parse_integer(str) == -1)
+		return (false);
+	*value = parse_integer(str);
+	return (true);
+}
+
+/* parse_choice:
+ *   Looks a word up in a comma-separated list of choices.
+ *
+ *   Parameters:
+ *     - str: The word to look up.
+ *     - choices: The list of choices, for example "plain,debug".
+ *
+ *   Returns:
+ *     - The position of the word in the list, or -1 if it is not in it.
+ */
+int	parse_choice(char *str, char *choices)
+{
+	int		index;
+	size_t	length;
+
+	index = 0;
+	length = strlen(str);
+	while (*choices)
+	{
+		if (strncmp(choices, str, length) == 0
+			&& (choices[length] == ',' || choices[length] == '\0'))
+			return (index);
+		while (*choices && *choices != ',')
+			choices++;
+		if (*choices == ',')
+			choices++;
+		index++;
+	}
+	return (-1);
+}
+
 /* is_valid_input:
- *   Checks if all required arguments are valid, i.e. is a string of
- *   digits only, which does not exceed INT_MAX. Also checks if the 
- *   number of philosophers is valid (between 1 and MAX_PHILOSOPHERS).
+ *   Checks if all command-line arguments are valid, i.e. is a string of
+ *   digits only, which does not exceed INT_MAX. The number of
+ *   philosophers is checked once all settings are loaded.
  *   Returns true if all arguments are valid, false if one of them 
  *   is invalid.
  *   
@@ -89,13 +138,7 @@ bool	is_valid_input(int argc, char **argv)
 	i = 1;
 	while (i < argc)
 	{
-		if (!contains_only_digits(argv[i]))
-			return (print_message(ERROR_INVALID_INPUT_DIGIT, argv[i], false));
-		nb = parse_integer(argv[i]);
-		if (i == 1 && (nb <= 0 || nb > MAX_PHILOSOPHERS))
-			return (print_message(ERROR_INVALID_INPUT_RANGE,
-					STR_MAX_PHILOSOPHERS, false));
-		if (i != 1 && nb == -1)
+		if (!parse_unsigned(argv[i], &nb))
 			return (print_message(ERROR_INVALID_INPUT_DIGIT, argv[i], false));
 		i++;
 	}
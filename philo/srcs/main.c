@@ -12,6 +12,35 @@
 
 #include "philosophers.h"
 
+/* abort_simulation:
+ *   Stops the philosophers already started, as threads or in worker
+ *   processes, after a thread of the main process could not be created,
+ *   then stops the output thread and the signal watcher and frees the
+ *   table.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ *     - started: The number of philosopher threads already created.
+ *
+ *   Returns:
+ *     - false, for start_simulation to return.
+ */
+static bool	abort_simulation(t_dining_table *dining_table,
+		unsigned int started)
+{
+	set_simulation_stop_flag(dining_table, true);
+	while (started > 0)
+		pthread_join(dining_table->philosophers[--started]->thread, NULL);
+	wait_workers(dining_table);
+	if (dining_table->output.started)
+	{
+		atomic_store(&dining_table->output.finish, true);
+		pthread_join(dining_table->output.thread, NULL);
+	}
+	stop_signal_watcher(dining_table);
+	return (print_error_and_exit(ERROR_THREAD_CREATION, NULL, dining_table));
+}
+
 /* start_simulation:
  *   Launches the simulation by creating a grim reaper thread as well as
  *   one thread for each philosopher.
@@ -23,9 +52,12 @@
  *     - dining_table: Pointer to the dining_table structure containing
  *       the philosophers and threads information.
  *   
- *   This function sets the start time for the simulation, then creates a 
- *   thread for each philosopher. If the number of philosophers is greater 
- *   than one, it also creates a grim reaper thread to monitor the simulation.
+ *   This function sets the start time for the simulation, then starts
+ *   the signal watcher, the output thread of the "merged" writer and a
+ *   thread for each philosopher, or the worker processes that run them
+ *   (see start_workers). If the number of philosophers is greater than
+ *   one, it also creates a grim reaper thread to monitor the simulation,
+ *   then the checkpoint and membership threads if they are enabled.
  *   If any thread creation fails, it prints an error message and exits.
  */
 static bool	start_simulation(t_dining_table *dining_table)
@@ -34,21 +66,47 @@ static bool	start_simulation(t_dining_table *dining_table)
 
 	dining_table->start_time = get_current_time_in_ms()
 		+ (dining_table->num_philosophers * 2 * 10);
+	resume_checkpoint(dining_table);
+	check_realtime(dining_table);
+	if (!start_signal_watcher(dining_table))
+		return (print_error_and_exit(ERROR_SIGNAL_WATCHER, NULL,
+				dining_table));
+	if (dining_table->settings.processes > 0
+		&& !start_workers(dining_table))
+	{
+		stop_signal_watcher(dining_table);
+		free_dining_table(dining_table);
+		return (false);
+	}
+	if (dining_table->settings.writer == WRITER_MERGED)
+	{
+		if (pthread_create(&dining_table->output.thread, NULL,
+				&output_routine, dining_table) != 0)
+			return (abort_simulation(dining_table, 0));
+		dining_table->output.started = true;
+	}
 	i = 0;
-	while (i < dining_table->num_philosophers)
+	while (dining_table->settings.processes == 0
+		&& i < dining_table->num_philosophers)
 	{
-		if (pthread_create(&dining_table->philosophers[i]->thread, NULL,
-				&philosopher_routine, dining_table->philosophers[i]) != 0)
-			return (print_error_and_exit(ERROR_THREAD_CREATION, NULL,
-					dining_table));
+		if (!create_philosopher_thread(dining_table, i))
+			return (abort_simulation(dining_table, i));
+		pin_thread(dining_table, dining_table->philosophers[i]->thread, i);
 		i++;
 	}
 	if (dining_table->num_philosophers > 1)
 	{
 		if (pthread_create(&dining_table->grim_reaper_thread, NULL,
 				&grim_reaper_routine, dining_table) != 0)
-			return (print_error_and_exit(ERROR_THREAD_CREATION, NULL,
-					dining_table));
+			return (abort_simulation(dining_table, i));
+	}
+	if (!start_checkpoints(dining_table) || !start_membership(dining_table))
+	{
+		set_simulation_stop_flag(dining_table, true);
+		stop_checkpoints(dining_table);
+		if (dining_table->num_philosophers > 1)
+			pthread_join(dining_table->grim_reaper_thread, NULL);
+		return (abort_simulation(dining_table, i));
 	}
 	return (true);
 }
@@ -61,31 +119,68 @@ static bool	start_simulation(t_dining_table *dining_table)
  *     - dining_table: Pointer to the dining_table structure containing
  *       the philosophers and threads information.
  *   
- *   This function waits for each philosopher thread to finish by calling 
- *   pthread_join. If there is a grim reaper thread, it waits for it to finish 
- *   as well. After all threads have been joined, it destroys all mutexes and 
- *   frees the allocated memory.
+ *   This function stops the checkpoint and membership threads, waits for
+ *   each philosopher thread or worker process and for the grim reaper to
+ *   finish, then lets the output thread print what is left. After all
+ *   threads have been joined, it stops the signal watcher, prints the
+ *   requested reports, destroys all mutexes and frees the allocated
+ *   memory. The reports and warnings go to the standard error, so that
+ *   the standard output stays a valid log.
+ *
+ *   Returns:
+ *     - EXIT_SUCCESS, or 128 plus the number of the signal that stopped
+ *       the run, as a shell reports a process killed by it.
  */
-static void	stop_simulation(t_dining_table *dining_table)
+static int	stop_simulation(t_dining_table *dining_table)
 {
 	unsigned int	i;
+	int				stop_signal;
 
+	stop_checkpoints(dining_table);
+	stop_membership(dining_table);
 	i = 0;
-	while (i < dining_table->num_philosophers)
+	while (dining_table->settings.processes == 0
+		&& !dining_table->membership.started
+		&& i < dining_table->num_philosophers)
 	{
 		pthread_join(dining_table->philosophers[i]->thread, NULL);
 		i++;
 	}
+	wait_workers(dining_table);
 	if (dining_table->num_philosophers > 1)
 		pthread_join(dining_table->grim_reaper_thread, NULL);
-	if (DEBUG_FORMATTING == true && dining_table->must_eat_count != -1)
+	if (dining_table->output.started)
+	{
+		atomic_store(&dining_table->output.finish, true);
+		pthread_join(dining_table->output.thread, NULL);
+	}
+	stop_signal_watcher(dining_table);
+	seat_final_philosophers(dining_table);
+	stop_signal = atomic_load(&dining_table->signals.stop_signal);
+	if (stop_signal == SIGINT)
+		fprintf(stderr, WARNING_SIGNAL_STOP, PROGRAM_NAME, "SIGINT");
+	else if (stop_signal == SIGTERM)
+		fprintf(stderr, WARNING_SIGNAL_STOP, PROGRAM_NAME, "SIGTERM");
+	print_dropped_output(&dining_table->output);
+	if (dining_table->settings.output_mode == OUTPUT_DEBUG
+		&& dining_table->must_eat_count != -1)
 		print_simulation_outcome(dining_table);
+	print_oracle_comparison(dining_table);
+	print_profile_report(dining_table);
+	print_memory_report(dining_table);
+	print_class_report(dining_table);
+	print_membership_report(dining_table);
+	print_checkpoint_report(dining_table);
+	print_compression_report(dining_table);
 	destroy_all_mutexes(dining_table);
 	free_dining_table(dining_table);
+	if (stop_signal != 0)
+		return (128 + stop_signal);
+	return (EXIT_SUCCESS);
 }
 
 /* main:
- *   Validates input arguments, initializes 
+ *   Loads the settings, initializes 
  *   the dining table, starts the simulation, and stops the simulation 
  *   once it finishes.
  *   
@@ -97,9 +192,13 @@ static void	stop_simulation(t_dining_table *dining_table)
  *     - EXIT_SUCCESS if the program completes successfully.
  *     - EXIT_FAILURE if there is an error during initialization 
  *       or simulation.
+ *     - 128 plus the signal number if SIGINT or SIGTERM stopped it.
  *   
- *   This function first checks if the number of arguments is valid. Then it 
- *   validates each argument and initializes the dining table. If everything 
+ *   This function first loads the settings from the config file, presets,
+ *   environment and arguments, and validates them. With a calibration
+ *   file, it then sets the safety margins of the sleeps for this host.
+ *   Then it initializes the dining table. With the "plan" oracle, it
+ *   only prints the schedule the table allows. Otherwise, if everything 
  *   is set up correctly, it starts the simulation and stops it once it 
  *   finishes. If there is any error during these steps, it prints an error 
  *   message and exits with a failure status.
@@ -107,17 +206,26 @@ static void	stop_simulation(t_dining_table *dining_table)
 int	main(int argc, char **argv)
 {
 	t_dining_table	*dining_table;
+	t_settings		settings;
 
-	dining_table = NULL;
-	if (argc - 1 < 4 || argc - 1 > 5)
-		return (print_message(USAGE_MESSAGE, NULL, EXIT_FAILURE));
-	if (!is_valid_input(argc, argv))
+	init_default_settings(&settings);
+	if (!load_settings(&settings, argc, argv)
+		|| (settings.calibration && !calibrate(&settings)))
+	{
+		free_settings(&settings);
 		return (EXIT_FAILURE);
-	dining_table = init_dining_table(argc, argv, 1);
+	}
+	dining_table = init_dining_table(&settings);
 	if (!dining_table)
 		return (EXIT_FAILURE);
+	if (dining_table->settings.oracle == ORACLE_PLAN)
+	{
+		print_oracle_plan(dining_table);
+		destroy_all_mutexes(dining_table);
+		free_dining_table(dining_table);
+		return (EXIT_SUCCESS);
+	}
 	if (!start_simulation(dining_table))
 		return (EXIT_FAILURE);
-	stop_simulation(dining_table);
-	return (EXIT_SUCCESS);
+	return (stop_simulation(dining_table));
 }
@@ -0,0 +1,331 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   membership.c                                       :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: antestem <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/07/11 17:01:44 by antestem          #+#    #+#             */
+/*   Updated: 2024/07/11 17:01:45 by antestem         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "philosophers.h"
+
+/* table_capacity:
+ *   Returns how many philosophers the table has room for: the number
+ *   of philosophers, or twice as many with membership churn, so that
+ *   the ring can grow while the run goes on.
+ *
+ *   Parameters:
+ *     - settings: Pointer to the loaded settings.
+ *
+ *   Returns:
+ *     - The number of philosophers and forks to allocate.
+ */
+unsigned int	table_capacity(t_settings *settings)
+{
+	if (settings->churn_interval_us > 0)
+		return (settings->num_philosophers * 2);
+	return (settings->num_philosophers);
+}
+
+/* init_membership:
+ *   With membership churn, seats the first num_philosophers philosophers
+ *   around the ring and puts the other entries of the philosophers array
+ *   aside for the philosophers who will join. Each philosopher brings
+ *   his own fork, the one with his index, and shares the fork of his
+ *   right neighbor. Frees the dining table if an allocation failed.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ *
+ *   Returns:
+ *     - A boolean indicating whether the membership is ready.
+ */
+bool	init_membership(t_dining_table *dining_table)
+{
+	t_membership	*membership;
+	t_seating		*seating;
+	unsigned int	i;
+
+	membership = &dining_table->membership;
+	if (dining_table->settings.churn_interval_us == 0)
+		return (true);
+	seating = malloc(sizeof(t_seating)
+			+ sizeof(unsigned int) * dining_table->num_philosophers);
+	membership->free_seats = malloc(sizeof(unsigned int)
+			* dining_table->capacity);
+	if (!seating || !membership->free_seats)
+	{
+		free(seating);
+		return (print_error_and_exit(ERROR_MEMORY_ALLOCATION, NULL,
+				dining_table));
+	}
+	seating->count = dining_table->num_philosophers;
+	i = 0;
+	while (i < seating->count)
+	{
+		seating->seats[i] = i;
+		atomic_store(&dining_table->philosophers[i]->right_fork,
+			(i + 1) % seating->count);
+		update_ring_forks(dining_table->philosophers[i++]);
+	}
+	while (i < dining_table->capacity)
+		membership->free_seats[membership->num_free++]
+			= dining_table->capacity - 1 - (i++ - seating->count);
+	membership->next_id = seating->count;
+	membership->seed = (dining_table->settings.churn_seed * NOISE_SEED_MIX)
+		^ (dining_table->capacity + 1);
+	atomic_store(&membership->epoch, 1);
+	atomic_store(&membership->seating, seating);
+	return (true);
+}
+
+/* enter_seating:
+ *   Starts a scan of the philosophers seated at the table by one of its
+ *   readers. The reader announces the current epoch before loading the
+ *   seating, so that the membership thread keeps every seating it may
+ *   load until leave_seating.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ *     - reader: The reader starting a scan.
+ *
+ *   Returns:
+ *     - The current seating, or NULL without membership churn, when the
+ *       philosophers array holds the seated philosophers in order.
+ */
+t_seating	*enter_seating(t_dining_table *dining_table,
+		t_seating_reader reader)
+{
+	t_membership	*membership;
+
+	if (dining_table->settings.churn_interval_us == 0)
+		return (NULL);
+	membership = &dining_table->membership;
+	atomic_store(&membership->readers[reader],
+		atomic_load(&membership->epoch));
+	return (atomic_load(&membership->seating));
+}
+
+/* leave_seating:
+ *   Ends a scan started with enter_seating.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ *     - reader: The reader ending its scan.
+ */
+void	leave_seating(t_dining_table *dining_table, t_seating_reader reader)
+{
+	if (dining_table->settings.churn_interval_us == 0)
+		return ;
+	atomic_store(&dining_table->membership.readers[reader], 0);
+}
+
+/* seated_philosopher:
+ *   Returns the i-th philosopher around the table.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ *     - seating: The seating returned by enter_seating.
+ *     - i: The seat, from 0 to the number of seated philosophers.
+ *
+ *   Returns:
+ *     - A pointer to the philosopher structure.
+ */
+t_philosopher	*seated_philosopher(t_dining_table *dining_table,
+		t_seating *seating, unsigned int i)
+{
+	if (seating == NULL)
+		return (dining_table->philosophers[i]);
+	return (dining_table->philosophers[seating->seats[i]]);
+}
+
+/* fork_rank:
+ *   Returns the rank of a fork in the order forks are taken with
+ *   membership churn: the even forks first, then the odd ones, each in
+ *   the order of their index. It only depends on the fork, so the order
+ *   never changes while the table runs, even as the entries of the
+ *   philosophers array and their forks are reused. Around the starting
+ *   ring, neighbors then take their forks in opposite directions, as in
+ *   the default ring.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ *     - fork: The index of the fork.
+ *
+ *   Returns:
+ *     - The rank of the fork.
+ */
+static unsigned int	fork_rank(t_dining_table *dining_table,
+		unsigned int fork)
+{
+	return ((fork % 2) * dining_table->capacity + fork);
+}
+
+/* update_ring_forks:
+ *   With membership churn, takes the fork of the philosopher's current
+ *   right neighbor, which changes when someone joins or leaves next to
+ *   him. It is only called while he holds no fork. Forks are always
+ *   taken in increasing order of their rank (see fork_rank). Since every
+ *   philosopher follows this one order, the ring stays free of deadlocks
+ *   whatever the seating: until a philosopher picks up his new neighbor,
+ *   he may still share a fork with the previous one, even once it was
+ *   given to a newcomer, but the fork locks keep that safe.
+ *
+ *   Parameters:
+ *     - philosopher: Pointer to the philosopher structure.
+ */
+void	update_ring_forks(t_philosopher *philosopher)
+{
+	t_dining_table	*dining_table;
+	unsigned int	right_fork;
+
+	dining_table = philosopher->dining_table;
+	if (dining_table->settings.churn_interval_us == 0)
+		return ;
+	right_fork = atomic_load(&philosopher->right_fork);
+	philosopher->forks[0] = philosopher->index;
+	philosopher->forks[1] = right_fork;
+	if (fork_rank(dining_table, right_fork)
+		< fork_rank(dining_table, philosopher->index))
+	{
+		philosopher->forks[0] = right_fork;
+		philosopher->forks[1] = philosopher->index;
+	}
+}
+
+/* publish_seating:
+ *   Replaces the seating the readers see, and retires the old one with
+ *   the epoch it was retired at. The epoch then moves on, so that the
+ *   readers entering afterwards do not hold back its reclamation.
+ *
+ *   Parameters:
+ *     - membership: Pointer to the table's membership.
+ *     - seating: The new seating.
+ *     - departed: The index of the philosopher who left, or NO_SEAT.
+ */
+void	publish_seating(t_membership *membership, t_seating *seating,
+		unsigned int departed)
+{
+	t_seating	*old;
+
+	old = atomic_load(&membership->seating);
+	atomic_store(&membership->seating, seating);
+	old->retired_epoch = atomic_fetch_add(&membership->epoch, 1);
+	old->departed = departed;
+	old->next_retired = membership->retired;
+	membership->retired = old;
+}
+
+/* oldest_reader_epoch:
+ *   Returns the oldest epoch announced by a reader in the middle of a
+ *   scan, or UINT64_MAX if no reader is scanning.
+ *
+ *   Parameters:
+ *     - membership: Pointer to the table's membership.
+ */
+static uint64_t	oldest_reader_epoch(t_membership *membership)
+{
+	uint64_t		oldest;
+	uint64_t		epoch;
+	unsigned int	i;
+
+	oldest = UINT64_MAX;
+	i = 0;
+	while (i < MEMBERSHIP_READERS)
+	{
+		epoch = atomic_load(&membership->readers[i++]);
+		if (epoch != 0 && epoch < oldest)
+			oldest = epoch;
+	}
+	return (oldest);
+}
+
+/* join_departed:
+ *   Joins the thread of the philosopher who left with a seating, if
+ *   any: only if it has already returned, unless wait is set.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ *     - seating: The retired seating.
+ *     - wait: Whether to wait for the thread to return.
+ *
+ *   Returns:
+ *     - A boolean indicating whether no thread is left to join.
+ */
+static bool	join_departed(t_dining_table *dining_table, t_seating *seating,
+		bool wait)
+{
+	pthread_t	thread;
+
+	if (seating->departed == NO_SEAT)
+		return (true);
+	thread = dining_table->philosophers[seating->departed]->thread;
+	if (wait)
+		return (pthread_join(thread, NULL) == 0);
+	return (pthread_tryjoin_np(thread, NULL) == 0);
+}
+
+/* reclaim_seatings:
+ *   Frees the retired seatings that no reader can still be scanning:
+ *   those retired before the oldest epoch a reader announced. The
+ *   philosopher who left with a seating is only joined then, and his
+ *   entry of the philosophers array made free for a newcomer, so that
+ *   no scan reads it while it is reset. If his thread has not returned
+ *   yet, the seating waits for the next reclamation, unless wait is set.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ *     - wait: Whether to wait for the threads of departed philosophers.
+ */
+void	reclaim_seatings(t_dining_table *dining_table, bool wait)
+{
+	t_membership	*membership;
+	t_seating		**link;
+	t_seating		*seating;
+	uint64_t		oldest;
+
+	membership = &dining_table->membership;
+	oldest = oldest_reader_epoch(membership);
+	link = &membership->retired;
+	while (*link)
+	{
+		seating = *link;
+		if (seating->retired_epoch >= oldest
+			|| !join_departed(dining_table, seating, wait))
+		{
+			link = &seating->next_retired;
+			continue ;
+		}
+		if (seating->departed != NO_SEAT)
+			membership->free_seats[membership->num_free++] = seating->departed;
+		*link = seating->next_retired;
+		free(seating);
+	}
+}
+
+/* free_membership:
+ *   Frees the seatings and the free indexes of the membership churn.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ */
+void	free_membership(t_dining_table *dining_table)
+{
+	t_membership	*membership;
+	t_seating		*seating;
+
+	membership = &dining_table->membership;
+	while (membership->retired)
+	{
+		seating = membership->retired;
+		membership->retired = seating->next_retired;
+		free(seating);
+	}
+	free(atomic_load(&membership->seating));
+	atomic_store(&membership->seating, NULL);
+	free(membership->free_seats);
+	membership->free_seats = NULL;
+}
@@ -0,0 +1,329 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   membership_churn.c                                 :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: antestem <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/07/11 17:01:46 by antestem          #+#    #+#             */
+/*   Updated: 2024/07/11 17:01:47 by antestem         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "philosophers.h"
+
+/* next_churn_random:
+ *   Returns the next pseudo-random number of the membership churn, from
+ *   its xorshift state seeded by the churn_seed setting.
+ *
+ *   Parameters:
+ *     - membership: Pointer to the table's membership.
+ */
+static unsigned int	next_churn_random(t_membership *membership)
+{
+	membership->seed ^= membership->seed << 13;
+	membership->seed ^= membership->seed >> 17;
+	membership->seed ^= membership->seed << 5;
+	return (membership->seed);
+}
+
+/* reset_newcomer:
+ *   Prepares a free entry of the philosophers array for a philosopher
+ *   joining the table, as init_philosophers does at the start: he gets
+ *   the next id, the table's timings and a fresh count of meals, and
+ *   starts as if he had just eaten. He shares the fork of his left
+ *   neighbor's right neighbor. Since newcomers start without meals, a
+ *   run with a number of meals to eat may only end once the churn lets
+ *   every seated philosopher catch up.
+ *
+ *   Parameters:
+ *     - philosopher: Pointer to the philosopher structure.
+ *     - id: The id of the newcomer.
+ *     - left: Pointer to his left neighbor.
+ */
+static void	reset_newcomer(t_philosopher *philosopher, unsigned int id,
+		t_philosopher *left)
+{
+	t_dining_table	*dining_table;
+
+	dining_table = philosopher->dining_table;
+	philosopher->id = id;
+	philosopher->backoff_seed = id + 1;
+	philosopher->noise_seed = (dining_table->settings.noise_seed
+			* NOISE_SEED_MIX) ^ (id + 1);
+	init_philosopher_timings(philosopher);
+	philosopher->forks_held = 0;
+	memset(&philosopher->profile, 0, sizeof(t_state_profile));
+	atomic_store(&philosopher->fork_waits, 0);
+	atomic_store(&philosopher->leaving, false);
+	atomic_store(&philosopher->right_fork, atomic_load(&left->right_fork));
+	update_ring_forks(philosopher);
+	pthread_mutex_lock(&philosopher->last_meal_lock);
+	philosopher->times_ate = 0;
+	philosopher->longest_hunger = 0;
+	philosopher->died = false;
+	philosopher->last_meal_time = get_current_time_in_ms();
+	record_phase(philosopher, PHILO_THINKING, 0);
+	pthread_mutex_unlock(&philosopher->last_meal_lock);
+}
+
+/* join_philosopher:
+ *   Seats a new philosopher to the right of the one in seat k, with a
+ *   free entry of the philosophers array and the fork it brings. His
+ *   thread is started before he is published in the seating, and his
+ *   left neighbor only swaps his right fork for the newcomer's once he
+ *   next puts his forks down (see update_ring_forks).
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ *     - seating: The current seating.
+ *     - k: The seat of the newcomer's left neighbor.
+ */
+static void	join_philosopher(t_dining_table *dining_table,
+		t_seating *seating, unsigned int k)
+{
+	t_membership	*membership;
+	t_seating		*next;
+	t_philosopher	*left;
+	t_philosopher	*newcomer;
+
+	membership = &dining_table->membership;
+	next = malloc(sizeof(t_seating)
+			+ sizeof(unsigned int) * (seating->count + 1));
+	if (!next)
+		return ;
+	left = dining_table->philosophers[seating->seats[k]];
+	newcomer = dining_table->philosophers[membership->\
+	free_seats[membership->num_free - 1]];
+	reset_newcomer(newcomer, membership->next_id, left);
+	if (!create_philosopher_thread(dining_table, newcomer->index))
+	{
+		free(next);
+		return ;
+	}
+	pin_thread(dining_table, newcomer->thread, newcomer->index);
+	membership->num_free--;
+	membership->next_id++;
+	next->count = seating->count + 1;
+	memcpy(next->seats, seating->seats, sizeof(unsigned int) * (k + 1));
+	next->seats[k + 1] = newcomer->index;
+	memcpy(next->seats + k + 2, seating->seats + k + 1,
+		sizeof(unsigned int) * (seating->count - k - 1));
+	publish_seating(membership, next, NO_SEAT);
+	atomic_store(&left->right_fork, newcomer->index);
+	membership->joins++;
+}
+
+/* leave_philosopher:
+ *   Makes the philosopher in seat k leave the table: his left neighbor
+ *   is given the fork he shared with his right neighbor, he disappears
+ *   from the seating, then he is told to leave. He does so once he puts
+ *   his forks down, and is joined when the old seating is reclaimed.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ *     - seating: The current seating.
+ *     - k: The seat of the philosopher leaving.
+ */
+static void	leave_philosopher(t_dining_table *dining_table,
+		t_seating *seating, unsigned int k)
+{
+	t_seating		*next;
+	t_philosopher	*left;
+	t_philosopher	*leaver;
+
+	next = malloc(sizeof(t_seating)
+			+ sizeof(unsigned int) * (seating->count - 1));
+	if (!next)
+		return ;
+	leaver = dining_table->philosophers[seating->seats[k]];
+	left = dining_table->philosophers[seating->seats[(k + seating->count - 1)
+			% seating->count]];
+	next->count = seating->count - 1;
+	memcpy(next->seats, seating->seats, sizeof(unsigned int) * k);
+	memcpy(next->seats + k, seating->seats + k + 1,
+		sizeof(unsigned int) * (seating->count - k - 1));
+	atomic_store(&left->right_fork, atomic_load(&leaver->right_fork));
+	publish_seating(&dining_table->membership, next, leaver->index);
+	atomic_store(&leaver->leaving, true);
+	dining_table->membership.leaves++;
+}
+
+/* churn_once:
+ *   Reclaims the seatings no reader needs anymore, then makes a random
+ *   philosopher leave or seats a newcomer next to a random one, with
+ *   even odds. At least two philosophers always stay seated, and no one
+ *   joins while every entry of the philosophers array is in use, either
+ *   by a seated philosopher or by one who left but was not joined yet:
+ *   the seating is then left as it is until the next change.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ */
+static void	churn_once(t_dining_table *dining_table)
+{
+	t_membership	*membership;
+	t_seating		*seating;
+	unsigned int	k;
+	bool			leave;
+
+	membership = &dining_table->membership;
+	reclaim_seatings(dining_table, false);
+	seating = atomic_load(&membership->seating);
+	k = next_churn_random(membership) % seating->count;
+	leave = next_churn_random(membership) % 2;
+	if (leave && seating->count > 2)
+		leave_philosopher(dining_table, seating, k);
+	else if (!leave && membership->num_free > 0)
+		join_philosopher(dining_table, seating, k);
+}
+
+/* membership_routine:
+ *   The membership thread's routine. Once the simulation has started,
+ *   changes the seating every churn_interval_us microseconds, on the
+ *   absolute clock, until the simulation stops. It checks for the stop
+ *   at least every reaper_interval_us.
+ *
+ *   Parameters:
+ *     - data: Pointer to the dining_table structure.
+ *
+ *   Returns:
+ *     - A NULL pointer when the simulation stops.
+ */
+static void	*membership_routine(void *data)
+{
+	t_dining_table	*dining_table;
+	uint64_t		next_churn;
+	uint64_t		now;
+	uint64_t		pause;
+
+	dining_table = (t_dining_table *)data;
+	delay_simulation_start(dining_table->start_time);
+	next_churn = get_current_time_in_ns()
+		+ (uint64_t)dining_table->settings.churn_interval_us * 1000;
+	while (!is_simulation_stopped(dining_table))
+	{
+		now = get_current_time_in_ns();
+		if (now >= next_churn)
+		{
+			churn_once(dining_table);
+			next_churn += (uint64_t)dining_table->settings.\
+			churn_interval_us * 1000;
+			continue ;
+		}
+		pause = (next_churn - now) / 1000;
+		if (pause > (uint64_t)dining_table->settings.reaper_interval_us)
+			pause = dining_table->settings.reaper_interval_us;
+		usleep(pause);
+	}
+	return (NULL);
+}
+
+/* start_membership:
+ *   Starts the membership thread, with membership churn.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ *
+ *   Returns:
+ *     - A boolean indicating whether the thread, if needed, was created.
+ */
+bool	start_membership(t_dining_table *dining_table)
+{
+	if (dining_table->settings.churn_interval_us == 0)
+		return (true);
+	if (pthread_create(&dining_table->membership.thread, NULL,
+			&membership_routine, dining_table) != 0)
+		return (false);
+	dining_table->membership.started = true;
+	return (true);
+}
+
+/* stop_membership:
+ *   Waits for the membership thread to return once the simulation has
+ *   stopped, then joins every philosopher's thread: the departed ones
+ *   as their seatings are reclaimed, once the readers are done with
+ *   them, and the seated ones.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ */
+void	stop_membership(t_dining_table *dining_table)
+{
+	t_membership	*membership;
+	t_seating		*seating;
+	unsigned int	i;
+
+	membership = &dining_table->membership;
+	if (!membership->started)
+		return ;
+	pthread_join(membership->thread, NULL);
+	reclaim_seatings(dining_table, true);
+	while (membership->retired)
+	{
+		usleep(dining_table->settings.reaper_interval_us);
+		reclaim_seatings(dining_table, true);
+	}
+	seating = atomic_load(&membership->seating);
+	i = 0;
+	while (i < seating->count)
+		pthread_join(dining_table->philosophers[seating->seats[i++]]->thread,
+			NULL);
+}
+
+/* seat_final_philosophers:
+ *   Once every thread was joined, moves the philosophers seated at the
+ *   end of the run to the front of the philosophers array, in the order
+ *   of the ring, so that the reports cover them like any other table.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ */
+void	seat_final_philosophers(t_dining_table *dining_table)
+{
+	t_seating		*seating;
+	t_philosopher	**order;
+	unsigned int	i;
+	unsigned int	j;
+
+	if (!dining_table->membership.started)
+		return ;
+	seating = atomic_load(&dining_table->membership.seating);
+	order = malloc(sizeof(t_philosopher *) * dining_table->capacity);
+	if (!order)
+		return ;
+	i = 0;
+	while (i < seating->count)
+	{
+		order[i] = dining_table->philosophers[seating->seats[i]];
+		dining_table->philosophers[seating->seats[i++]] = NULL;
+	}
+	j = 0;
+	while (j < dining_table->capacity)
+	{
+		if (dining_table->philosophers[j] != NULL)
+			order[i++] = dining_table->philosophers[j];
+		j++;
+	}
+	memcpy(dining_table->philosophers, order,
+		sizeof(t_philosopher *) * dining_table->capacity);
+	free(order);
+	dining_table->num_philosophers = seating->count;
+}
+
+/* print_membership_report:
+ *   With membership churn, prints on the standard error how many
+ *   philosophers joined and left the table, and how many were seated
+ *   at the end.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ */
+void	print_membership_report(t_dining_table *dining_table)
+{
+	if (!dining_table->membership.started)
+		return ;
+	fprintf(stderr, "membership: joins %lu leaves %lu seated %u\n",
+		dining_table->membership.joins, dining_table->membership.leaves,
+		dining_table->num_philosophers);
+}
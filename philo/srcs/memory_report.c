@@ -0,0 +1,119 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   memory_report.c                                    :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: antestem <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/07/11 17:01:36 by antestem          #+#    #+#             */
+/*   Updated: 2024/07/11 17:01:37 by antestem         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "philosophers.h"
+#include <sys/resource.h>
+
+/* read_status:
+ *   Reads /proc/self/status, whose size fstat does not report, into a
+ *   null-terminated buffer.
+ *
+ *   Parameters:
+ *     - buffer: Where to store the contents.
+ *     - size: The size of the buffer.
+ *
+ *   Returns:
+ *     - A boolean indicating whether the file could be read.
+ */
+static bool	read_status(char *buffer, size_t size)
+{
+	int		fd;
+	ssize_t	bytes_read;
+	size_t	total;
+
+	fd = open("/proc/self/status", O_RDONLY);
+	if (fd < 0)
+		return (false);
+	total = 0;
+	bytes_read = 1;
+	while (bytes_read > 0 && total < size - 1)
+	{
+		bytes_read = read(fd, buffer + total, size - 1 - total);
+		if (bytes_read > 0)
+			total += bytes_read;
+	}
+	close(fd);
+	buffer[total] = '\0';
+	return (total > 0);
+}
+
+/* status_kb:
+ *   Finds one of the "Vm" fields of /proc/self/status.
+ *
+ *   Parameters:
+ *     - status: The contents of /proc/self/status.
+ *     - field: The name of the field, with its colon.
+ *
+ *   Returns:
+ *     - The value of the field in kilobytes, or 0 if it is missing.
+ */
+static long	status_kb(char *status, char *field)
+{
+	char	*line;
+
+	line = strstr(status, field);
+	if (!line)
+		return (0);
+	return (strtol(line + strlen(field), NULL, 10));
+}
+
+/* print_memory_row:
+ *   Prints one row of the memory report: a size, and that size divided
+ *   among the philosophers.
+ *
+ *   Parameters:
+ *     - name: The name of the row.
+ *     - kb: The size, in kilobytes.
+ *     - num_philosophers: The number of philosophers at the table.
+ */
+static void	print_memory_row(char *name, long kb,
+		unsigned int num_philosophers)
+{
+	fprintf(stderr, "memory: %-16s %12ld %18.1f\n", name, kb,
+		(double)kb / num_philosophers);
+}
+
+/* print_memory_report:
+ *   Prints on the standard error how much memory the run used with the
+ *   "memory" profile: the peak resident and virtual sizes of the
+ *   process, the largest peak resident size of the worker processes,
+ *   and the part of the arena and of the stack region of the "low"
+ *   footprint mode in use.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure, whose
+ *       philosopher threads have all been joined.
+ */
+void	print_memory_report(t_dining_table *dining_table)
+{
+	char			status[8192];
+	struct rusage	usage;
+	unsigned int	n;
+
+	if (dining_table->settings.profile != PROFILE_MEMORY)
+		return ;
+	n = dining_table->num_philosophers;
+	if (!read_status(status, sizeof(status)))
+		status[0] = '\0';
+	fprintf(stderr, "memory: %-16s %12s %18s\n", "", "kb",
+		"per_philosopher_kb");
+	print_memory_row("peak_rss", status_kb(status, "VmHWM:"), n);
+	print_memory_row("peak_virtual", status_kb(status, "VmPeak:"), n);
+	if (dining_table->num_workers > 0
+		&& getrusage(RUSAGE_CHILDREN, &usage) == 0)
+		print_memory_row("worker_peak_rss", usage.ru_maxrss, n);
+	if (dining_table->arena)
+		print_memory_row("arena_used", dining_table->arena->used / 1024, n);
+	if (dining_table->stacks.region)
+		print_memory_row("stacks_mapped",
+			dining_table->stacks.region_size / 1024, n);
+}
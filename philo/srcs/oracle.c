@@ -0,0 +1,182 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   oracle.c                                           :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: antestem <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/07/11 17:01:26 by antestem          #+#    #+#             */
+/*   Updated: 2024/07/11 17:01:27 by antestem         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "philosophers.h"
+
+/* meals_per_second:
+ *   Returns the meal rate of a schedule: every philosopher eats once
+ *   per period.
+ */
+static double	meals_per_second(t_dining_table *dining_table)
+{
+	return (dining_table->num_philosophers * 1e9
+		/ dining_table->schedule.period_ns);
+}
+
+/* print_parity_slot:
+ *   Prints the slot of a two-slot schedule, in which the philosophers
+ *   with the same parity as the first one start eating: all of them if
+ *   there are up to four, or else the first two and the last one.
+ *
+ *   Parameters:
+ *     - offset_ns: The start of the slot in the period, in nanoseconds.
+ *     - first: The id of the first philosopher of the slot, 1 or 2.
+ *     - count: The number of philosophers at the table.
+ */
+static void	print_parity_slot(double offset_ns, unsigned int first,
+		unsigned int count)
+{
+	unsigned int	last;
+	unsigned int	id;
+
+	last = count - (count - first) % 2;
+	if (last > first)
+		printf("oracle:   +%.3f ms: philosophers %u", offset_ns / 1e6, first);
+	else
+		printf("oracle:   +%.3f ms: philosopher %u", offset_ns / 1e6, first);
+	id = first + 2;
+	if (last > first + 6)
+	{
+		printf(", %u, ..., %u", id, last);
+		id = last + 1;
+	}
+	while (id <= last)
+	{
+		printf(", %u", id);
+		id += 2;
+	}
+	if (first % 2)
+		printf(" (odd)\n");
+	else
+		printf(" (even)\n");
+}
+
+/* print_schedule_slots:
+ *   Prints who starts eating when in each period. With an even number
+ *   of philosophers, half of them start at once; with an odd number,
+ *   one philosopher starts in each slot, the one whose id times
+ *   slots_per_meal is the slot modulo the number of slots, that is, id
+ *   -2 * slot.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ */
+static void	print_schedule_slots(t_dining_table *dining_table)
+{
+	t_schedule		*schedule;
+	unsigned int	slot;
+	unsigned int	id;
+
+	schedule = &dining_table->schedule;
+	printf("oracle: schedule, repeating every %.3f ms; each philosopher "
+		"eats %ld ms, sleeps %ld ms, then thinks until his next turn:\n",
+		schedule->period_ns / 1e6, dining_table->time_to_eat,
+		dining_table->time_to_sleep);
+	if (schedule->num_slots == 2)
+	{
+		print_parity_slot(0, 1, dining_table->num_philosophers);
+		print_parity_slot(schedule->slot_ns, 2,
+			dining_table->num_philosophers);
+		return ;
+	}
+	slot = 0;
+	while (slot < schedule->num_slots)
+	{
+		id = (schedule->num_slots - 2 * slot % schedule->num_slots)
+			% schedule->num_slots;
+		printf("oracle:   +%.3f ms: philosopher %u\n",
+			schedule_offset(schedule, id) / 1e6, id + 1);
+		slot++;
+	}
+}
+
+/* print_oracle_plan:
+ *   Prints, without running anything, whether a schedule exists in
+ *   which nobody dies, the highest meal rate the table can sustain, and
+ *   that schedule (see plan_schedule).
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ */
+void	print_oracle_plan(t_dining_table *dining_table)
+{
+	t_schedule		*schedule;
+	unsigned int	meals;
+
+	schedule = &dining_table->schedule;
+	printf("oracle: philosophers %u, time_to_die %ld, time_to_eat %ld, "
+		"time_to_sleep %ld\n", dining_table->num_philosophers,
+		dining_table->time_to_die, dining_table->time_to_eat,
+		dining_table->time_to_sleep);
+	if (!schedule->exists)
+	{
+		if (dining_table->settings.topology || dining_table->settings.timings)
+			printf("oracle: only the default ring of forks, with the same "
+				"timings for everyone, can be planned\n");
+		else
+			printf("oracle: survivable: no, a lone philosopher has only "
+				"one fork\n");
+		return ;
+	}
+	meals = dining_table->num_philosophers * schedule->slots_per_meal
+		/ schedule->num_slots;
+	if (meals == 1)
+		printf("oracle: up to 1 meal at once");
+	else
+		printf("oracle: up to %u meals at once", meals);
+	printf("; each philosopher can eat every %.3f ms\n",
+		schedule->period_ns / 1e6);
+	if (schedule->survivable)
+		printf("oracle: survivable: yes, with %.3f ms to spare\n",
+			dining_table->time_to_die - schedule->period_ns / 1e6);
+	else
+		printf("oracle: survivable: no, time_to_die must be above "
+			"%.3f ms\n", schedule->period_ns / 1e6);
+	printf("oracle: max sustainable rate: %.3f meals/s\n",
+		meals_per_second(dining_table));
+	if (schedule->survivable)
+		print_schedule_slots(dining_table);
+}
+
+/* print_oracle_comparison:
+ *   Once the simulation is over, prints on the standard error its meal
+ *   rate and compares it with the highest rate the table can sustain.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure, whose
+ *       philosopher threads have all been joined.
+ */
+void	print_oracle_comparison(t_dining_table *dining_table)
+{
+	unsigned long	meals;
+	unsigned int	i;
+	time_t			elapsed;
+
+	if (dining_table->settings.oracle != ORACLE_COMPARE)
+		return ;
+	meals = 0;
+	i = 0;
+	while (i < dining_table->num_philosophers)
+		meals += dining_table->philosophers[i++]->times_ate;
+	elapsed = get_current_time_in_ms() - dining_table->start_time;
+	if (elapsed < 1)
+		elapsed = 1;
+	fprintf(stderr, "oracle: %lu meals in %ld ms: %.3f meals/s",
+		meals, elapsed, meals * 1000.0 / elapsed);
+	if (dining_table->schedule.exists)
+		fprintf(stderr, ", %.1f%% of the %.3f meals/s bound",
+			meals * 1000.0 / elapsed * 100 / meals_per_second(dining_table),
+			meals_per_second(dining_table));
+	if (dining_table->schedule.exists && !dining_table->schedule.survivable)
+		fprintf(stderr, ", which no schedule survives");
+	fprintf(stderr, "\n");
+}
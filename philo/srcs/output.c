@@ -16,56 +16,26 @@
  *   Prints the philosopher's status in an easier to read,
  *   colorful format to help with debugging. For fork-taking
  *   statuses, extra information is displayed to show which fork
- *   the philosopher has taken.
+ *   the philosopher has taken last. For this option, the output
+ *   setting must be "debug" (or DEBUG_FORMATTING set to 1 in
+ *   philosophers.h, which makes it the default).
  *
  *   Parameters:
  *     - philosopher: Pointer to the philosopher structure.
- *     - color: The color code for the status message.
- *     - status_str: The status message to be printed.
  *     - status: The current status of the philosopher.
  */
-static void	print_status_debug(t_philosopher *philosopher, char *color,
-		char *status_str, t_philosopher_status status)
-{
-	if (status == PHILO_GOT_FORK_1)
-		printf("[%10ld]\t%s%03d\t%s\e[0m: fork [%d]\n", get_current_time_in_ms()
-			- philosopher->dining_table->start_time, color, philosopher->id + 1,
-			status_str, philosopher->fork[0]);
-	else if (status == PHILO_GOT_FORK_2)
-		printf("[%10ld]\t%s%03d\t%s\e[0m: fork [%d]\n", get_current_time_in_ms()
-			- philosopher->dining_table->start_time, color, philosopher->id + 1,
-			status_str, philosopher->fork[1]);
-	else
-		printf("[%10ld]\t%s%03d\t%s\e[0m\n", get_current_time_in_ms()
-			- philosopher->dining_table->start_time, color, philosopher->id + 1,
-			status_str);
-}
-
-/* write_status_debug:
- *   Redirects the status writing for debug mode. For this option,
- *   the DEBUG_FORMATTING option must be set to 1 in philosophers.h.
- *
- *   Parameters:
- *     - philosopher: Pointer to the philosopher structure.
- *     - status: The current status of the philosopher.
- */
-static void	write_status_debug(t_philosopher *philosopher,
+static void	print_status_debug(t_philosopher *philosopher,
 		t_philosopher_status status)
 {
-	if (status == PHILO_DIED)
-		print_status_debug(philosopher, COLOR_RED, "died", status);
-	else if (status == PHILO_EATING)
-		print_status_debug(philosopher, COLOR_GREEN, "is eating", status);
-	else if (status == PHILO_SLEEPING)
-		print_status_debug(philosopher, COLOR_CYAN, "is sleeping", status);
-	else if (status == PHILO_THINKING)
-		print_status_debug(philosopher, COLOR_CYAN, "is thinking", status);
-	else if (status == PHILO_GOT_FORK_1)
-		print_status_debug(philosopher, COLOR_PURPLE, "has taken a fork",
-			status);
-	else if (status == PHILO_GOT_FORK_2)
-		print_status_debug(philosopher, COLOR_PURPLE, "has taken a fork",
-			status);
+	if (status == PHILO_GOT_FORK)
+		printf(FORK_DEBUG_FORMAT, get_current_time_in_ms()
+			- philosopher->dining_table->start_time, status_color(status),
+			philosopher->id + 1, status_message(status),
+			philosopher->forks[philosopher->forks_held - 1]);
+	else
+		printf(STATUS_DEBUG_FORMAT, get_current_time_in_ms()
+			- philosopher->dining_table->start_time, status_color(status),
+			philosopher->id + 1, status_message(status));
 }
 
 /* print_status:
@@ -75,13 +45,14 @@ static void	write_status_debug(t_philosopher *philosopher,
  *
  *   Parameters:
  *     - philosopher: Pointer to the philosopher structure.
- *     - status_str: The status message to be printed.
+ *     - status: The current status of the philosopher.
  */
-static void	print_status(t_philosopher *philosopher, char *status_str)
+static void	print_status(t_philosopher *philosopher,
+		t_philosopher_status status)
 {
-	printf("%ld %d %s\n", get_current_time_in_ms()
+	printf(STATUS_FORMAT, get_current_time_in_ms()
 		- philosopher->dining_table->start_time, philosopher->id + 1,
-		status_str);
+		status_message(status));
 }
 
 /* philo_stat:
@@ -89,11 +60,22 @@ static void	print_status(t_philosopher *philosopher, char *status_str)
  *   still active. Locks the write mutex to avoid intertwined messages
  *   from different threads.
  *
- *   If DEBUG_FORMATTING is set to 1 in philosophers.h, the status will
+ *   If the output setting is "debug", the status will
  *   be formatted with colors and extra information to help with debugging.
  *   Otherwise, the output will be the regular format required by the project
  *   subject.
  *
+ *   With the "merged" writer, the status is instead added to the
+ *   philosopher's own output ring without taking the write mutex, and
+ *   the output thread prints it (see output_merger.c).
+ *
+ *   When the philosophers run in worker processes, each process has its
+ *   own stdio buffer, so the status is flushed before the write mutex is
+ *   released to keep the output in order.
+ *
+ *   With the "states" profile, the time a philosopher spends here counts
+ *   as overhead.
+ *
  *   Parameters:
  *     - philosopher: Pointer to the philosopher structure.
  *     - is_reaper: Boolean indicating if the status is from the reaper.
@@ -102,29 +84,34 @@ static void	print_status(t_philosopher *philosopher, char *status_str)
 void	philo_stat(t_philosopher *philosopher, bool is_reaper,
 		t_philosopher_status status)
 {
-	pthread_mutex_lock(&philosopher->dining_table->write_lock);
-	if (is_simulation_stopped(philosopher->dining_table) && !is_reaper)
+	uint64_t	overhead;
+
+	overhead = 0;
+	if (!is_reaper)
+		overhead = profile_overhead_start(philosopher);
+	if (philosopher->dining_table->settings.writer == WRITER_MERGED)
 	{
-		pthread_mutex_unlock(&philosopher->dining_table->write_lock);
+		if (is_reaper)
+			report_output_death(philosopher);
+		else
+			push_output_event(philosopher, status);
+		profile_overhead_end(philosopher, overhead);
 		return ;
 	}
-	if (DEBUG_FORMATTING)
+	pthread_mutex_lock(&philosopher->dining_table->write_lock);
+	if (!is_reaper)
+		NOISE_POINT(philosopher->dining_table, &philosopher->noise_seed);
+	if (!is_simulation_stopped(philosopher->dining_table) || is_reaper)
 	{
-		write_status_debug(philosopher, status);
-		pthread_mutex_unlock(&philosopher->dining_table->write_lock);
-		return ;
+		if (philosopher->dining_table->settings.output_mode == OUTPUT_DEBUG)
+			print_status_debug(philosopher, status);
+		else
+			print_status(philosopher, status);
+		if (philosopher->dining_table->settings.processes > 0)
+			fflush(stdout);
 	}
-	if (status == PHILO_DIED)
-		print_status(philosopher, "died");
-	else if (status == PHILO_EATING)
-		print_status(philosopher, "is eating");
-	else if (status == PHILO_SLEEPING)
-		print_status(philosopher, "is sleeping");
-	else if (status == PHILO_THINKING)
-		print_status(philosopher, "is thinking");
-	else if (status == PHILO_GOT_FORK_1 || status == PHILO_GOT_FORK_2)
-		print_status(philosopher, "has taken a fork");
 	pthread_mutex_unlock(&philosopher->dining_table->write_lock);
+	profile_overhead_end(philosopher, overhead);
 }
 
 /* print_simulation_outcome:
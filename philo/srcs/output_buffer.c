@@ -0,0 +1,169 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   output_buffer.c                                    :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: antestem <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/07/11 17:01:10 by antestem          #+#    #+#             */
+/*   Updated: 2024/07/11 17:01:11 by antestem         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "philosophers.h"
+
+/* init_output:
+ *   Allocates the output rings of the philosophers, the merge heap and
+ *   the output buffers used by the "merged" writer, with the block and
+ *   hash table of the "compressed" output, and initializes the
+ *   lock the output and writer threads share. Frees the dining table if
+ *   an allocation fails.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ *
+ *   Returns:
+ *     - A boolean indicating whether the output was initialized.
+ */
+bool	init_output(t_dining_table *dining_table)
+{
+	t_output		*output;
+	unsigned int	i;
+
+	output = &dining_table->output;
+	atomic_init(&output->dead_philosopher, -1);
+	output->rings = table_alloc(dining_table,
+			sizeof(t_output_ring) * dining_table->num_philosophers,
+			_Alignof(t_output_ring));
+	output->heap = table_alloc(dining_table, sizeof(unsigned int)
+			* dining_table->num_philosophers, _Alignof(unsigned int));
+	output->pool = table_alloc(dining_table,
+			OUTPUT_BUFFER_SIZE * OUTPUT_BUFFERS, CACHE_LINE_SIZE);
+	output->buffer = output->pool;
+	output->io = dining_table->settings.output_io;
+	if (dining_table->settings.output_mode == OUTPUT_COMPRESSED)
+	{
+		output->codec.block = table_alloc(dining_table, CODEC_BLOCK_SIZE, 1);
+		output->codec.hash = table_alloc(dining_table,
+				sizeof(uint32_t) << CODEC_HASH_BITS, _Alignof(uint32_t));
+	}
+	if (!output->rings || !output->heap || !output->pool
+		|| (dining_table->settings.output_mode == OUTPUT_COMPRESSED
+			&& (!output->codec.block || !output->codec.hash)))
+		return (print_error_and_exit(ERROR_MEMORY_ALLOCATION, NULL,
+				dining_table));
+	if (pthread_mutex_init(&output->writer_lock, NULL) != 0)
+		return (print_error_and_exit(ERROR_MUTEX_CREATION, NULL,
+				dining_table));
+	if (pthread_cond_init(&output->writer_cond, NULL) != 0)
+	{
+		pthread_mutex_destroy(&output->writer_lock);
+		return (print_error_and_exit(ERROR_MUTEX_CREATION, NULL,
+				dining_table));
+	}
+	output->writer_sync = true;
+	i = 0;
+	while (i < dining_table->num_philosophers)
+	{
+		output->rings[i].events = table_alloc(dining_table,
+				sizeof(t_output_event) * OUTPUT_RING_SIZE,
+				_Alignof(t_output_event));
+		if (!output->rings[i].events)
+			return (print_error_and_exit(ERROR_MEMORY_ALLOCATION, NULL,
+					dining_table));
+		i++;
+	}
+	return (true);
+}
+
+/* push_output_event:
+ *   Adds a status to the philosopher's output ring, for the output
+ *   thread to print. Only this philosopher writes to the ring, so no
+ *   lock is needed: the event is published by moving head. While the
+ *   event is being added, pending tells the output thread which time
+ *   it is about to have, so that no later event is printed before it.
+ *   Waits for room if the ring is full. Like philo_stat, adds nothing
+ *   once the simulation has stopped.
+ *
+ *   Parameters:
+ *     - philosopher: Pointer to the philosopher structure.
+ *     - status: The current status of the philosopher.
+ */
+void	push_output_event(t_philosopher *philosopher,
+		t_philosopher_status status)
+{
+	t_output_ring	*ring;
+	t_output_event	*event;
+	size_t			head;
+
+	ring = &philosopher->dining_table->output.rings[philosopher->id];
+	head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+	while (head - atomic_load_explicit(&ring->tail, memory_order_acquire)
+		>= OUTPUT_RING_SIZE)
+	{
+		if (is_simulation_stopped(philosopher->dining_table))
+			return ;
+		usleep(philosopher->dining_table->settings.sleep_granularity_us);
+	}
+	NOISE_POINT(philosopher->dining_table, &philosopher->noise_seed);
+	event = &ring->events[head % OUTPUT_RING_SIZE];
+	atomic_store(&ring->pending, OUTPUT_BUSY);
+	event->time = get_current_time_in_ns();
+	atomic_store(&ring->pending, event->time);
+	if (!is_simulation_stopped(philosopher->dining_table))
+	{
+		event->philosopher = philosopher->id;
+		event->status = status;
+		event->fork = 0;
+		if (status == PHILO_GOT_FORK)
+			event->fork = philosopher->forks[philosopher->forks_held - 1];
+		atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+	}
+	atomic_store(&ring->pending, OUTPUT_IDLE);
+}
+
+/* report_output_death:
+ *   Tells the output thread that a philosopher died, once the grim
+ *   reaper has stopped the simulation. The output thread prints every
+ *   event from before the death, then the death, then nothing else.
+ *
+ *   Parameters:
+ *     - philosopher: Pointer to the philosopher who died.
+ */
+void	report_output_death(t_philosopher *philosopher)
+{
+	t_output	*output;
+
+	output = &philosopher->dining_table->output;
+	atomic_store(&output->death_time, get_current_time_in_ns());
+	atomic_store(&output->dead_philosopher, philosopher->id);
+}
+
+/* free_output:
+ *   Frees the output rings, the merge heap, the output buffers and the
+ *   codec's, and destroys the writer lock.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ */
+void	free_output(t_dining_table *dining_table)
+{
+	unsigned int	i;
+
+	if (dining_table->output.rings)
+	{
+		i = 0;
+		while (i < dining_table->num_philosophers)
+			table_free(dining_table, dining_table->output.rings[i++].events);
+	}
+	if (dining_table->output.writer_sync)
+	{
+		pthread_mutex_destroy(&dining_table->output.writer_lock);
+		pthread_cond_destroy(&dining_table->output.writer_cond);
+	}
+	table_free(dining_table, dining_table->output.rings);
+	table_free(dining_table, dining_table->output.heap);
+	table_free(dining_table, dining_table->output.pool);
+	table_free(dining_table, dining_table->output.codec.block);
+	table_free(dining_table, dining_table->output.codec.hash);
+}
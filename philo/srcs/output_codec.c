@@ -0,0 +1,294 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   output_codec.c                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: antestem <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/07/11 17:01:58 by antestem          #+#    #+#             */
+/*   Updated: 2024/07/11 17:01:59 by antestem         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "philosophers.h"
+
+/* put_varint:
+ *   Writes a number 7 bits per byte, the lowest first, the high bit of
+ *   each byte telling whether another one follows.
+ *
+ *   Parameters:
+ *     - out: Where to write the number, at least 10 bytes.
+ *     - value: The number.
+ *
+ *   Returns:
+ *     - The byte after the number.
+ */
+static unsigned char	*put_varint(unsigned char *out, uint64_t value)
+{
+	while (value >= 128)
+	{
+		*out++ = (value & 127) | 128;
+		value >>= 7;
+	}
+	*out++ = value;
+	return (out);
+}
+
+/* text_length:
+ *   Counts the bytes the plain output would have taken for an event, for
+ *   the compression report.
+ *
+ *   Parameters:
+ *     - timestamp: The timestamp of the event, in milliseconds.
+ *     - event: The event.
+ *
+ *   Returns:
+ *     - The length of the line.
+ */
+static size_t	text_length(long timestamp, t_output_event *event)
+{
+	size_t			length;
+	unsigned long	value;
+
+	length = strlen(status_message(event->status)) + 3;
+	if (timestamp < 0)
+		length++;
+	value = labs(timestamp);
+	while (value >= 10)
+	{
+		value /= 10;
+		length++;
+	}
+	value = event->philosopher + 1;
+	while (value > 0)
+	{
+		value /= 10;
+		length++;
+	}
+	return (length + 1);
+}
+
+/* encode_output_event:
+ *   Codes an event into the block of the "compressed" output, on the
+ *   output thread, sealing the block first if the event may not fit.
+ *   One byte holds the status, whether the philosopher is the same as in
+ *   the last event, and the delta of the timestamp if it is below
+ *   CODEC_DELTA_ESCAPE. Otherwise, the delta follows, zigzag-coded so
+ *   that it may be negative, then the philosopher if he changed.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ *     - event: The event to code.
+ */
+void	encode_output_event(t_dining_table *dining_table, t_output_event *event)
+{
+	t_output_codec	*codec;
+	unsigned char	*out;
+	long			timestamp;
+	long			delta;
+
+	codec = &dining_table->output.codec;
+	if (codec->length + CODEC_EVENT_MAX > CODEC_BLOCK_SIZE)
+		seal_output_block(&dining_table->output, true);
+	if (codec->length == 0)
+		codec->opened = get_current_time_in_ms();
+	timestamp = event->time / 1000000 - dining_table->start_time;
+	delta = timestamp - codec->timestamp;
+	out = codec->block + codec->length;
+	*out = event->status;
+	if (event->philosopher == codec->philosopher)
+		*out |= CODEC_SAME_PHILOSOPHER;
+	if (delta >= 0 && delta < CODEC_DELTA_ESCAPE)
+		*out++ |= delta << 4;
+	else
+	{
+		*out++ |= CODEC_DELTA_ESCAPE << 4;
+		out = put_varint(out, ((uint64_t)delta << 1) ^ (delta >> 63));
+	}
+	if (event->philosopher != codec->philosopher)
+		out = put_varint(out, event->philosopher);
+	codec->length = out - codec->block;
+	codec->timestamp = timestamp;
+	codec->philosopher = event->philosopher;
+	codec->text_bytes += text_length(timestamp, event);
+}
+
+/* store32:
+ *   Writes a 32 bit number of the stream, little endian.
+ */
+static void	store32(char *out, uint32_t value)
+{
+	out[0] = value & 0xff;
+	out[1] = (value >> 8) & 0xff;
+	out[2] = (value >> 16) & 0xff;
+	out[3] = value >> 24;
+}
+
+/* start_codec_stream:
+ *   Puts CODEC_MAGIC at the start of the stream, in the output buffer.
+ *
+ *   Parameters:
+ *     - output: Pointer to the output structure.
+ */
+static void	start_codec_stream(t_output *output)
+{
+	if (output->codec.started)
+		return ;
+	store32(output->buffer + output->length, CODEC_MAGIC);
+	output->length += 4;
+	output->codec.compressed_bytes += 4;
+	output->codec.started = true;
+}
+
+/* seal_output_block:
+ *   Compresses the block of coded events into the output buffer, after
+ *   its raw and compressed sizes, and hands it to the writer thread. So
+ *   that matches can be found across many events, a block is only
+ *   sealed once full, at the end of the output, or once it was opened
+ *   CODEC_SEAL_MS ago, so that a reader following the log is never much
+ *   further behind. The output buffer has room for the stream's magic
+ *   and a whole block even if nothing compresses.
+ *
+ *   Parameters:
+ *     - output: Pointer to the output structure.
+ *     - force: Whether to seal the block however recent it is.
+ */
+void	seal_output_block(t_output *output, bool force)
+{
+	t_output_codec	*codec;
+	size_t			compressed;
+
+	codec = &output->codec;
+	if (codec->length == 0 || (!force
+			&& get_current_time_in_ms() - codec->opened < CODEC_SEAL_MS))
+		return ;
+	start_codec_stream(output);
+	compressed = lz_compress(codec->block, codec->length,
+			(unsigned char *)output->buffer + output->length
+			+ CODEC_HEADER_SIZE, codec->hash);
+	store32(output->buffer + output->length, codec->length);
+	store32(output->buffer + output->length + 4, compressed);
+	output->length += CODEC_HEADER_SIZE + compressed;
+	codec->compressed_bytes += CODEC_HEADER_SIZE + compressed;
+	codec->length = 0;
+	flush_output(output);
+}
+
+/* finish_output_codec:
+ *   Seals the last block and ends the stream with an empty one.
+ *
+ *   Parameters:
+ *     - output: Pointer to the output structure.
+ */
+void	finish_output_codec(t_output *output)
+{
+	seal_output_block(output, true);
+	start_codec_stream(output);
+	memset(output->buffer + output->length, 0, CODEC_HEADER_SIZE);
+	output->length += CODEC_HEADER_SIZE;
+	output->codec.compressed_bytes += CODEC_HEADER_SIZE;
+	flush_output(output);
+}
+
+/* get_varint:
+ *   Reads a number written by put_varint.
+ *
+ *   Parameters:
+ *     - codec: Pointer to the decoder, whose block is being read.
+ *     - in: The position in the block, moved past the number.
+ *     - value: Where to store the number.
+ *
+ *   Returns:
+ *     - A boolean indicating whether the number ends inside the block.
+ */
+static bool	get_varint(t_output_codec *codec, size_t *in, uint64_t *value)
+{
+	unsigned int	shift;
+	unsigned char	byte;
+
+	*value = 0;
+	shift = 0;
+	byte = 128;
+	while (byte & 128)
+	{
+		if (*in >= codec->length || shift > 63)
+			return (false);
+		byte = codec->block[(*in)++];
+		*value |= (uint64_t)(byte & 127) << shift;
+		shift += 7;
+	}
+	return (true);
+}
+
+/* decode_output_block:
+ *   Decompresses a block of the "compressed" output and prints its
+ *   events exactly as the plain output would have. The decoder keeps
+ *   the timestamp and philosopher of the last event from one block to
+ *   the next, as the encoder does.
+ *
+ *   Parameters:
+ *     - codec: Pointer to the decoder, whose block holds at least
+ *       CODEC_BLOCK_SIZE bytes.
+ *     - block: The block, from its sizes on.
+ *     - out: Where to print the events.
+ *
+ *   Returns:
+ *     - A boolean indicating whether the block was valid.
+ */
+bool	decode_output_block(t_output_codec *codec, unsigned char *block,
+		FILE *out)
+{
+	size_t			in;
+	uint64_t		value;
+	unsigned char	header;
+
+	codec->length = block[0] | block[1] << 8 | block[2] << 16
+		| (uint32_t)block[3] << 24;
+	value = block[4] | block[5] << 8 | block[6] << 16
+		| (uint32_t)block[7] << 24;
+	if (codec->length > CODEC_BLOCK_SIZE || !lz_decompress(block
+			+ CODEC_HEADER_SIZE, value, codec->block, codec->length))
+		return (false);
+	in = 0;
+	while (in < codec->length)
+	{
+		header = codec->block[in++];
+		value = header >> 4;
+		if ((header & 7) > PHILO_GOT_FORK || (value == CODEC_DELTA_ESCAPE
+				&& !get_varint(codec, &in, &value)))
+			return (false);
+		if (header >> 4 == CODEC_DELTA_ESCAPE)
+			value = (value >> 1) ^ -(value & 1);
+		codec->timestamp += (long)value;
+		if (!(header & CODEC_SAME_PHILOSOPHER))
+		{
+			if (!get_varint(codec, &in, &value))
+				return (false);
+			codec->philosopher = value;
+		}
+		fprintf(out, STATUS_FORMAT, codec->timestamp,
+			(int)codec->philosopher + 1, status_message(header & 7));
+	}
+	return (true);
+}
+
+/* print_compression_report:
+ *   With the "compressed" output, prints on the standard error how many
+ *   events were written, how long their plain text would have been and
+ *   how long the stream is.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ */
+void	print_compression_report(t_dining_table *dining_table)
+{
+	t_output_codec	*codec;
+
+	if (dining_table->settings.output_mode != OUTPUT_COMPRESSED)
+		return ;
+	codec = &dining_table->output.codec;
+	fprintf(stderr, "compression: %lu events, %lu bytes of text in %lu "
+		"bytes, ratio %.2f\n", dining_table->output.events, codec->text_bytes,
+		codec->compressed_bytes, (double)codec->text_bytes
+		/ codec->compressed_bytes);
+}
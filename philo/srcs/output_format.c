@@ -0,0 +1,84 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   output_format.c                                    :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: antestem <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/07/11 17:01:08 by antestem          #+#    #+#             */
+/*   Updated: 2024/07/11 17:01:09 by antestem         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "philosophers.h"
+
+/* status_message:
+ *   Returns the text printed for a status.
+ *
+ *   Parameters:
+ *     - status: The status of the philosopher.
+ */
+char	*status_message(t_philosopher_status status)
+{
+	if (status == PHILO_DIED)
+		return ("died");
+	if (status == PHILO_EATING)
+		return ("is eating");
+	if (status == PHILO_SLEEPING)
+		return ("is sleeping");
+	if (status == PHILO_THINKING)
+		return ("is thinking");
+	return ("has taken a fork");
+}
+
+/* status_color:
+ *   Returns the color of a status in the debug output.
+ *
+ *   Parameters:
+ *     - status: The status of the philosopher.
+ */
+char	*status_color(t_philosopher_status status)
+{
+	if (status == PHILO_DIED)
+		return (COLOR_RED);
+	if (status == PHILO_EATING)
+		return (COLOR_GREEN);
+	if (status == PHILO_GOT_FORK)
+		return (COLOR_PURPLE);
+	return (COLOR_CYAN);
+}
+
+/* format_event:
+ *   Formats a buffered output event the same way philo_stat prints a
+ *   status, in the plain or debug format.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ *     - event: The event to format.
+ *     - buffer: Where to write the line, at least OUTPUT_LINE_MAX long.
+ *
+ *   Returns:
+ *     - The length of the line.
+ */
+size_t	format_event(t_dining_table *dining_table, t_output_event *event,
+		char *buffer)
+{
+	long	timestamp;
+	int		length;
+
+	timestamp = event->time / 1000000 - dining_table->start_time;
+	if (dining_table->settings.output_mode != OUTPUT_DEBUG)
+		length = snprintf(buffer, OUTPUT_LINE_MAX, STATUS_FORMAT, timestamp,
+				event->philosopher + 1, status_message(event->status));
+	else if (event->status == PHILO_GOT_FORK)
+		length = snprintf(buffer, OUTPUT_LINE_MAX, FORK_DEBUG_FORMAT,
+				timestamp, status_color(event->status), event->philosopher + 1,
+				status_message(event->status), event->fork);
+	else
+		length = snprintf(buffer, OUTPUT_LINE_MAX, STATUS_DEBUG_FORMAT,
+				timestamp, status_color(event->status), event->philosopher + 1,
+				status_message(event->status));
+	if (length < 0)
+		return (0);
+	return (length);
+}
@@ -0,0 +1,124 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   output_heap.c                                      :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: antestem <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/07/11 17:01:12 by antestem          #+#    #+#             */
+/*   Updated: 2024/07/11 17:01:13 by antestem         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "philosophers.h"
+
+/* is_before:
+ *   Compares the next events of two output rings by time, then by
+ *   philosopher, so that the merge order is always the same.
+ *
+ *   Parameters:
+ *     - output: Pointer to the output structure.
+ *     - a: The index of the first ring.
+ *     - b: The index of the second ring.
+ *
+ *   Returns:
+ *     - A boolean indicating whether ring a's event comes first.
+ */
+static bool	is_before(t_output *output, unsigned int a, unsigned int b)
+{
+	uint64_t	time_a;
+	uint64_t	time_b;
+
+	time_a = output->rings[a].events[output->rings[a].next
+		% OUTPUT_RING_SIZE].time;
+	time_b = output->rings[b].events[output->rings[b].next
+		% OUTPUT_RING_SIZE].time;
+	return (time_a < time_b || (time_a == time_b && a < b));
+}
+
+/* sift_down:
+ *   Moves a ring down the merge heap until its next event comes before
+ *   the next events of both its children.
+ *
+ *   Parameters:
+ *     - output: Pointer to the output structure.
+ *     - position: The position of the ring in the heap.
+ */
+static void	sift_down(t_output *output, unsigned int position)
+{
+	unsigned int	child;
+	unsigned int	ring;
+
+	while (position * 2 + 1 < output->heap_size)
+	{
+		child = position * 2 + 1;
+		if (child + 1 < output->heap_size
+			&& is_before(output, output->heap[child + 1], output->heap[child]))
+			child++;
+		if (!is_before(output, output->heap[child], output->heap[position]))
+			return ;
+		ring = output->heap[position];
+		output->heap[position] = output->heap[child];
+		output->heap[child] = ring;
+		position = child;
+	}
+}
+
+/* build_output_heap:
+ *   Builds the merge heap out of every ring that has events to print
+ *   between next and limit, with the earliest event on top.
+ *
+ *   Parameters:
+ *     - output: Pointer to the output structure.
+ *     - num_rings: The number of output rings.
+ */
+void	build_output_heap(t_output *output, unsigned int num_rings)
+{
+	unsigned int	i;
+
+	output->heap_size = 0;
+	i = 0;
+	while (i < num_rings)
+	{
+		if (output->rings[i].next < output->rings[i].limit)
+			output->heap[output->heap_size++] = i;
+		i++;
+	}
+	i = output->heap_size / 2;
+	while (i-- > 0)
+		sift_down(output, i);
+}
+
+/* output_heap_top:
+ *   Returns the earliest event left to merge, or NULL if there is none.
+ *
+ *   Parameters:
+ *     - output: Pointer to the output structure.
+ */
+t_output_event	*output_heap_top(t_output *output)
+{
+	t_output_ring	*ring;
+
+	if (output->heap_size == 0)
+		return (NULL);
+	ring = &output->rings[output->heap[0]];
+	return (&ring->events[ring->next % OUTPUT_RING_SIZE]);
+}
+
+/* pop_output_heap:
+ *   Moves past the earliest event, and takes its ring out of the heap
+ *   if it has no more events to merge.
+ *
+ *   Parameters:
+ *     - output: Pointer to the output structure.
+ */
+void	pop_output_heap(t_output *output)
+{
+	t_output_ring	*ring;
+
+	ring = &output->rings[output->heap[0]];
+	ring->next++;
+	if (ring->next == ring->limit)
+		output->heap[0] = output->heap[--output->heap_size];
+	sift_down(output, 0);
+}
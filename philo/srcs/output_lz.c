@@ -0,0 +1,229 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   output_lz.c                                        :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: antestem <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/07/11 17:01:56 by antestem          #+#    #+#             */
+/*   Updated: 2024/07/11 17:01:57 by antestem         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "philosophers.h"
+
+/* read32:
+ *   Reads four bytes of the source in the host's order, to compare or
+ *   hash them at once.
+ */
+static uint32_t	read32(unsigned char *bytes)
+{
+	uint32_t	value;
+
+	memcpy(&value, bytes, sizeof(value));
+	return (value);
+}
+
+/* put_length:
+ *   Writes the part of a length beyond its 4 bits in the token: bytes
+ *   of 255 followed by the rest.
+ *
+ *   Parameters:
+ *     - out: Where to write the length.
+ *     - length: The part of the length to write.
+ *
+ *   Returns:
+ *     - The byte after the length.
+ */
+static unsigned char	*put_length(unsigned char *out, size_t length)
+{
+	while (length >= 255)
+	{
+		*out++ = 255;
+		length -= 255;
+	}
+	*out++ = length;
+	return (out);
+}
+
+/* put_sequence:
+ *   Writes one sequence of the compressed block, as LZ4 does: a token
+ *   holding the number of literals and the length of the match, 4 bits
+ *   each, the literals, then the offset of the match on 2 bytes, little
+ *   endian. A length of 15 or more goes on in the bytes that follow its
+ *   part of the token. The last sequence has literals only.
+ *
+ *   Parameters:
+ *     - out: Where to write the sequence.
+ *     - literals: The bytes to copy as they are.
+ *     - count: The number of literals.
+ *     - match: The offset and length of the match, or NULL.
+ *
+ *   Returns:
+ *     - The byte after the sequence.
+ */
+static unsigned char	*put_sequence(unsigned char *out,
+		unsigned char *literals, size_t count, size_t *match)
+{
+	unsigned char	*token;
+
+	token = out++;
+	*token = count << 4;
+	if (count >= 15)
+	{
+		*token = 15 << 4;
+		out = put_length(out, count - 15);
+	}
+	memcpy(out, literals, count);
+	out += count;
+	if (!match)
+		return (out);
+	*out++ = match[0] & 0xff;
+	*out++ = match[0] >> 8;
+	if (match[1] - CODEC_MIN_MATCH >= 15)
+	{
+		*token |= 15;
+		return (put_length(out, match[1] - CODEC_MIN_MATCH - 15));
+	}
+	*token |= match[1] - CODEC_MIN_MATCH;
+	return (out);
+}
+
+/* lz_compress:
+ *   Compresses a block with a greedy LZ77 in the LZ4 block format: the
+ *   hash of every 4 bytes remembers where they were last seen, and when
+ *   they are seen again, the match is extended as far as it goes. The
+ *   coded events repeat a lot, a philosopher's fork, fork and meal for
+ *   example, so most of them end up in matches. The destination must
+ *   hold length + length / 255 + 16 bytes.
+ *
+ *   Parameters:
+ *     - source: The block to compress, at most 65535 bytes.
+ *     - length: The length of the block.
+ *     - destination: Where to write the compressed block.
+ *     - hash: A table of 1 << CODEC_HASH_BITS positions, reset here.
+ *
+ *   Returns:
+ *     - The length of the compressed block.
+ */
+size_t	lz_compress(unsigned char *source, size_t length,
+		unsigned char *destination, uint32_t *hash)
+{
+	unsigned char	*out;
+	size_t			match[2];
+	size_t			anchor;
+	size_t			i;
+	uint32_t		slot;
+
+	memset(hash, 0, sizeof(uint32_t) << CODEC_HASH_BITS);
+	out = destination;
+	anchor = 0;
+	i = 0;
+	while (i + CODEC_MIN_MATCH <= length)
+	{
+		slot = (uint32_t)(read32(source + i) * 2654435761U)
+			>> (32 - CODEC_HASH_BITS);
+		match[0] = i + 1 - hash[slot];
+		hash[slot] = i + 1;
+		if (match[0] > i || read32(source + i - match[0])
+			!= read32(source + i))
+		{
+			i++;
+			continue ;
+		}
+		match[1] = CODEC_MIN_MATCH;
+		while (i + match[1] < length
+			&& source[i + match[1] - match[0]] == source[i + match[1]])
+			match[1]++;
+		out = put_sequence(out, source + anchor, i - anchor, match);
+		i += match[1];
+		anchor = i;
+	}
+	out = put_sequence(out, source + anchor, length - anchor, NULL);
+	return (out - destination);
+}
+
+/* get_length:
+ *   Reads the part of a length that goes on after its token.
+ *
+ *   Parameters:
+ *     - source: The compressed block.
+ *     - length: The length of the compressed block.
+ *     - in: The position in the block, moved past the length.
+ *     - count: The length, to which the bytes read are added.
+ *
+ *   Returns:
+ *     - A boolean indicating whether the length ends inside the block.
+ */
+static bool	get_length(unsigned char *source, size_t length, size_t *in,
+		size_t *count)
+{
+	unsigned char	byte;
+
+	byte = 255;
+	while (byte == 255)
+	{
+		if (*in >= length)
+			return (false);
+		byte = source[(*in)++];
+		*count += byte;
+	}
+	return (true);
+}
+
+/* lz_decompress:
+ *   Decompresses a block written by lz_compress. Every length and
+ *   offset is checked, so that a damaged block is refused instead of
+ *   reading or writing out of bounds.
+ *
+ *   Parameters:
+ *     - source: The compressed block.
+ *     - length: The length of the compressed block.
+ *     - destination: Where to write the block, expected bytes long.
+ *     - expected: The length of the block once decompressed.
+ *
+ *   Returns:
+ *     - A boolean indicating whether the block was exactly expected
+ *       bytes long.
+ */
+bool	lz_decompress(unsigned char *source, size_t length,
+		unsigned char *destination, size_t expected)
+{
+	unsigned char	token;
+	size_t			in;
+	size_t			out;
+	size_t			count;
+	size_t			offset;
+
+	in = 0;
+	out = 0;
+	while (in < length)
+	{
+		token = source[in++];
+		count = token >> 4;
+		if (count == 15 && !get_length(source, length, &in, &count))
+			return (false);
+		if (count > length - in || count > expected - out)
+			return (false);
+		memcpy(destination + out, source + in, count);
+		in += count;
+		out += count;
+		if (in == length)
+			break ;
+		if (length - in < 2)
+			return (false);
+		offset = source[in] | source[in + 1] << 8;
+		in += 2;
+		count = (token & 15) + CODEC_MIN_MATCH;
+		if ((token & 15) == 15 && !get_length(source, length, &in, &count))
+			return (false);
+		if (offset == 0 || offset > out || count > expected - out)
+			return (false);
+		while (count-- > 0)
+		{
+			destination[out] = destination[out - offset];
+			out++;
+		}
+	}
+	return (out == expected);
+}
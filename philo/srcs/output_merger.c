@@ -0,0 +1,189 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   output_merger.c                                    :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: antestem <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/07/11 17:01:14 by antestem          #+#    #+#             */
+/*   Updated: 2024/07/11 17:01:15 by antestem         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "philosophers.h"
+
+/* snapshot_rings:
+ *   Finds how far the output rings can be merged: up to bound, but not
+ *   up to the time of an event a philosopher is still adding, since it
+ *   must be printed before any later one. Then records where each ring
+ *   ends, in limit. A philosopher reading the clock takes a few
+ *   nanoseconds, so the output thread just yields until it is done.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ *     - bound: The time of the latest event that may be printed, read
+ *       before this call.
+ *     - wait: Whether to wait for the events being added up to bound,
+ *       instead of stopping before them.
+ *
+ *   Returns:
+ *     - The time of the latest event that may be printed.
+ */
+static uint64_t	snapshot_rings(t_dining_table *dining_table, uint64_t bound,
+		bool wait)
+{
+	t_output_ring	*ring;
+	uint64_t		pending;
+	unsigned int	i;
+
+	i = 0;
+	while (i < TABLE_PHILOSOPHERS(dining_table))
+	{
+		ring = &dining_table->output.rings[i++];
+		pending = atomic_load(&ring->pending);
+		while (pending == OUTPUT_BUSY
+			|| (wait && pending != OUTPUT_IDLE && pending <= bound))
+		{
+			sched_yield();
+			pending = atomic_load(&ring->pending);
+		}
+		if (pending != OUTPUT_IDLE && pending <= bound)
+			bound = pending - 1;
+		ring->limit = atomic_load_explicit(&ring->head, memory_order_acquire);
+	}
+	return (bound);
+}
+
+/* print_event:
+ *   Formats an event into the output buffer, or with the "compressed"
+ *   output, codes it into the block being compressed.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ *     - event: The event to print.
+ */
+static void	print_event(t_dining_table *dining_table, t_output_event *event)
+{
+	t_output	*output;
+
+	output = &dining_table->output;
+	if (dining_table->settings.output_mode == OUTPUT_COMPRESSED)
+	{
+		encode_output_event(dining_table, event);
+		return ;
+	}
+	if (output->length + OUTPUT_LINE_MAX > OUTPUT_BUFFER_SIZE)
+		flush_output(output);
+	output->length += format_event(dining_table, event,
+			output->buffer + output->length);
+}
+
+/* merge_until:
+ *   Merges the snapshotted events of every ring in time order, with a
+ *   k-way merge over the heap of rings, and formats them into the output
+ *   buffer, up to bound. Nothing is printed after a death. Then gives
+ *   the room of the printed events back to the philosophers.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ *     - bound: The time of the latest event to print.
+ */
+static void	merge_until(t_dining_table *dining_table, uint64_t bound)
+{
+	t_output		*output;
+	t_output_event	*event;
+	unsigned int	i;
+
+	output = &dining_table->output;
+	build_output_heap(output, TABLE_PHILOSOPHERS(dining_table));
+	event = output_heap_top(output);
+	while (event && event->time <= bound && !output->closed)
+	{
+		print_event(dining_table, event);
+		output->closed = (event->status == PHILO_DIED);
+		output->events++;
+		pop_output_heap(output);
+		event = output_heap_top(output);
+	}
+	i = 0;
+	while (i < TABLE_PHILOSOPHERS(dining_table))
+	{
+		atomic_store_explicit(&output->rings[i].tail, output->rings[i].next,
+			memory_order_release);
+		i++;
+	}
+}
+
+/* merge_death:
+ *   Prints every event from before the death reported by the grim
+ *   reaper, then the death itself, and closes the output. Events the
+ *   philosophers were adding when the simulation stopped are waited for
+ *   if they happened before the death.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ */
+static void	merge_death(t_dining_table *dining_table)
+{
+	t_output		*output;
+	t_output_event	death;
+
+	output = &dining_table->output;
+	memset(&death, 0, sizeof(t_output_event));
+	death.time = atomic_load(&output->death_time);
+	death.philosopher = atomic_load(&output->dead_philosopher);
+	death.status = PHILO_DIED;
+	merge_until(dining_table, snapshot_rings(dining_table, death.time, true));
+	if (output->closed)
+		return ;
+	print_event(dining_table, &death);
+	output->closed = true;
+}
+
+/* output_routine:
+ *   The output thread's routine with the "merged" writer. Every
+ *   flush_interval_us, merges the events the philosophers added to their
+ *   rings since the last time and hands them to the writer thread. A
+ *   death is printed at the next flush at the latest. Once the
+ *   simulation is over and every philosopher has returned, prints the
+ *   events left and waits for the writer thread to write everything.
+ *   With the "compressed" output, the events are compressed here too,
+ *   so that the philosophers never wait for it (see seal_output_block).
+ *
+ *   Parameters:
+ *     - data: Pointer to the dining_table structure.
+ *
+ *   Returns:
+ *     - NULL when the routine is finished.
+ */
+void	*output_routine(void *data)
+{
+	t_dining_table	*dining_table;
+	t_output		*output;
+	bool			final;
+
+	dining_table = (t_dining_table *)data;
+	output = &dining_table->output;
+	final = false;
+	start_output_writer(output);
+	while (!final && !output->closed)
+	{
+		final = atomic_load(&output->finish);
+		if (!final)
+			usleep(dining_table->settings.flush_interval_us);
+		if (atomic_load(&output->dead_philosopher) >= 0)
+			merge_death(dining_table);
+		else if (final)
+			merge_until(dining_table,
+				snapshot_rings(dining_table, UINT64_MAX, true));
+		else
+			merge_until(dining_table, snapshot_rings(dining_table,
+					get_current_time_in_ns(), false));
+		seal_output_block(output, final || output->closed);
+		flush_output(output);
+	}
+	if (dining_table->settings.output_mode == OUTPUT_COMPRESSED)
+		finish_output_codec(output);
+	stop_output_writer(output);
+	return (NULL);
+}
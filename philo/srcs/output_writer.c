@@ -0,0 +1,210 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   output_writer.c                                    :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: antestem <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/07/11 17:01:16 by antestem          #+#    #+#             */
+/*   Updated: 2024/07/11 17:01:17 by antestem         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "philosophers.h"
+#include <poll.h>
+
+/* drop_buffers:
+ *   Gives up on what is left of the buffers after a write failed for
+ *   good, such as on a closed pipe, and counts the bytes lost, so that
+ *   the end of the run can warn that the log is truncated.
+ *
+ *   Parameters:
+ *     - output: Pointer to the output structure.
+ *     - iov: The buffers left, from the one the write failed on.
+ *     - count: The number of buffers left.
+ */
+static void	drop_buffers(t_output *output, struct iovec *iov,
+		unsigned int count)
+{
+	unsigned int	i;
+
+	i = 0;
+	while (i < count)
+		output->dropped_bytes += iov[i++].iov_len;
+}
+
+/* write_buffers:
+ *   Writes full output buffers to the standard output, all in one
+ *   writev call when possible, or one write call per buffer with the
+ *   "write" output_io setting or if writev is not supported. Partial
+ *   writes are resumed where they stopped, and a non-blocking standard
+ *   output that is full is waited for. Any other error drops the rest
+ *   (see drop_buffers).
+ *
+ *   Parameters:
+ *     - output: Pointer to the output structure.
+ *     - first: The index of the first buffer to write.
+ *     - count: The number of buffers to write.
+ */
+static void	write_buffers(t_output *output, unsigned int first,
+		unsigned int count)
+{
+	struct iovec	iov[OUTPUT_BUFFERS];
+	unsigned int	done;
+	ssize_t			result;
+	struct pollfd	fd;
+
+	done = 0;
+	while (done < count)
+	{
+		iov[done].iov_base = output->pool + (first + done) % OUTPUT_BUFFERS
+			* OUTPUT_BUFFER_SIZE;
+		iov[done].iov_len = output->lengths[(first + done) % OUTPUT_BUFFERS];
+		done++;
+	}
+	done = 0;
+	while (done < count)
+	{
+		if (output->io == OUTPUT_WRITEV)
+			result = writev(STDOUT_FILENO, iov + done, count - done);
+		else
+			result = write(STDOUT_FILENO, iov[done].iov_base,
+					iov[done].iov_len);
+		output->syscalls++;
+		if (result < 0 && output->io == OUTPUT_WRITEV
+			&& (errno == ENOSYS || errno == EINVAL))
+			output->io = OUTPUT_WRITE;
+		else if (result < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+		{
+			fd.fd = STDOUT_FILENO;
+			fd.events = POLLOUT;
+			poll(&fd, 1, -1);
+		}
+		else if (result < 0 && errno != EINTR)
+		{
+			drop_buffers(output, iov + done, count - done);
+			return ;
+		}
+		while (result > 0 && (size_t)result >= iov[done].iov_len)
+			result -= iov[done++].iov_len;
+		if (result > 0)
+			iov[done].iov_base = (char *)iov[done].iov_base + result;
+		if (result > 0)
+			iov[done].iov_len -= result;
+	}
+}
+
+/* writer_routine:
+ *   The writer thread's routine. Waits for full output buffers and
+ *   writes all of those that are ready at once, while the output thread
+ *   keeps filling the next ones. Returns once stop_output_writer was
+ *   called and everything was written.
+ *
+ *   Parameters:
+ *     - data: Pointer to the output structure.
+ *
+ *   Returns:
+ *     - NULL when the routine is finished.
+ */
+static void	*writer_routine(void *data)
+{
+	t_output		*output;
+	unsigned int	first;
+	unsigned int	count;
+
+	output = (t_output *)data;
+	pthread_mutex_lock(&output->writer_lock);
+	while (output->num_ready > 0 || !output->writer_done)
+	{
+		if (output->num_ready == 0)
+		{
+			pthread_cond_wait(&output->writer_cond, &output->writer_lock);
+			continue ;
+		}
+		first = output->first_ready;
+		count = output->num_ready;
+		pthread_mutex_unlock(&output->writer_lock);
+		write_buffers(output, first, count);
+		pthread_mutex_lock(&output->writer_lock);
+		output->first_ready = (first + count) % OUTPUT_BUFFERS;
+		output->num_ready -= count;
+		pthread_cond_broadcast(&output->writer_cond);
+	}
+	pthread_mutex_unlock(&output->writer_lock);
+	return (NULL);
+}
+
+/* flush_output:
+ *   Hands the buffer the output thread was filling to the writer thread
+ *   and moves on to the next one, so that formatting does not wait for
+ *   the write. Only waits if every buffer is still being written. Without
+ *   a writer thread, writes the buffer directly.
+ *
+ *   Parameters:
+ *     - output: Pointer to the output structure.
+ */
+void	flush_output(t_output *output)
+{
+	if (output->length == 0)
+		return ;
+	output->lengths[output->current] = output->length;
+	if (!output->writer_started)
+		write_buffers(output, output->current, 1);
+	else
+	{
+		pthread_mutex_lock(&output->writer_lock);
+		output->num_ready++;
+		pthread_cond_broadcast(&output->writer_cond);
+		while (output->num_ready == OUTPUT_BUFFERS)
+			pthread_cond_wait(&output->writer_cond, &output->writer_lock);
+		pthread_mutex_unlock(&output->writer_lock);
+		output->current = (output->current + 1) % OUTPUT_BUFFERS;
+	}
+	output->buffer = output->pool + output->current * OUTPUT_BUFFER_SIZE;
+	output->length = 0;
+}
+
+/* start_output_writer:
+ *   Starts the writer thread. If it cannot be created, the output
+ *   thread writes its buffers itself.
+ *
+ *   Parameters:
+ *     - output: Pointer to the output structure.
+ */
+void	start_output_writer(t_output *output)
+{
+	output->writer_started = (pthread_create(&output->writer_thread, NULL,
+				&writer_routine, output) == 0);
+}
+
+/* print_dropped_output:
+ *   Warns, on the standard error, that the log is truncated if some of
+ *   the output could not be written.
+ *
+ *   Parameters:
+ *     - output: Pointer to the output structure.
+ */
+void	print_dropped_output(t_output *output)
+{
+	if (output->dropped_bytes > 0)
+		fprintf(stderr, WARNING_OUTPUT_DROPPED, PROGRAM_NAME,
+			output->dropped_bytes);
+}
+
+/* stop_output_writer:
+ *   Lets the writer thread write the buffers left and waits for it.
+ *
+ *   Parameters:
+ *     - output: Pointer to the output structure.
+ */
+void	stop_output_writer(t_output *output)
+{
+	if (!output->writer_started)
+		return ;
+	pthread_mutex_lock(&output->writer_lock);
+	output->writer_done = true;
+	pthread_cond_broadcast(&output->writer_cond);
+	pthread_mutex_unlock(&output->writer_lock);
+	pthread_join(output->writer_thread, NULL);
+	output->writer_started = false;
+}
@@ -13,51 +13,75 @@
 #include "philosophers.h"
 
 /* eat_and_sleep_routine:
- *   When a philosopher is ready to eat, he will wait for his fork mutexes to
- *   be unlocked before locking them. Then the philosopher will eat for a certain
- *   amount of time. The time of the last meal is recorded at the beginning of
- *   the meal, not at the end, as per the subject's requirements.
+ *   When a philosopher is ready to eat, he takes his forks using the
+ *   table's fork acquisition mode, and gives up if the simulation stops
+ *   before he gets them all. Then he eats and sleeps for his own
+ *   durations (see jittered_duration and record_phase). The time of the
+ *   last meal is recorded at the beginning of the meal, as per the
+ *   subject's requirements, under the last meal lock with the "is
+ *   eating" message, so that the grim reaper never sees the message
+ *   without the new time.
  *
  *   Parameters:
  *     - philosopher: Pointer to the philosopher structure.
+ *     - resumed: Whether this is the meal a checkpoint was taken during
+ *       (see resume_checkpoint).
  */
-static void	eat_and_sleep_routine(t_philosopher *philosopher)
+static void	eat_and_sleep_routine(t_philosopher *philosopher, bool resumed)
 {
-	pthread_mutex_lock(&philosopher->dining_table->\
-	fork_locks[philosopher->fork[0]]);
-	philo_stat(philosopher, false, PHILO_GOT_FORK_1);
-	pthread_mutex_lock(&philosopher->dining_table->\
-	fork_locks[philosopher->fork[1]]);
-	philo_stat(philosopher, false, PHILO_GOT_FORK_2);
-	philo_stat(philosopher, false, PHILO_EATING);
+	time_t	now;
+	time_t	duration;
+
+	update_ring_forks(philosopher);
+	update_realtime_priority(philosopher);
+	if (!take_forks(philosopher))
+		return ;
+	NOISE_POINT(philosopher->dining_table, &philosopher->noise_seed);
+	profile_transition(philosopher, STATE_EATING);
 	pthread_mutex_lock(&philosopher->last_meal_lock);
-	philosopher->last_meal_time = get_current_time_in_ms();
+	philo_stat(philosopher, false, PHILO_EATING);
+	now = get_current_time_in_ms();
+	duration = atomic_load_explicit(&philosopher->phase.end,
+			memory_order_relaxed) - now;
+	if (!resumed)
+	{
+		record_meal_start(philosopher, now);
+		duration = jittered_duration(philosopher,
+				PHILO_TIME_TO_EAT(philosopher));
+	}
+	record_phase(philosopher, PHILO_EATING, now + duration);
 	pthread_mutex_unlock(&philosopher->last_meal_lock);
-	philosopher_sleep(philosopher->dining_table,
-		philosopher->dining_table->time_to_eat);
+	philosopher_sleep(philosopher, duration);
+	duration = 0;
 	if (!is_simulation_stopped(philosopher->dining_table))
 	{
+		NOISE_POINT(philosopher->dining_table, &philosopher->noise_seed);
 		pthread_mutex_lock(&philosopher->last_meal_lock);
 		philosopher->times_ate += 1;
+		duration = jittered_duration(philosopher,
+				PHILO_TIME_TO_SLEEP(philosopher));
+		record_phase(philosopher, PHILO_SLEEPING,
+			get_current_time_in_ms() + duration);
 		pthread_mutex_unlock(&philosopher->last_meal_lock);
 	}
+	profile_transition(philosopher, STATE_SLEEPING);
 	philo_stat(philosopher, false, PHILO_SLEEPING);
-	pthread_mutex_unlock(&philosopher->dining_table->\
-	fork_locks[philosopher->fork[1]]);
-	pthread_mutex_unlock(&philosopher->dining_table->\
-	fork_locks[philosopher->fork[0]]);
-	philosopher_sleep(philosopher->dining_table,
-		philosopher->dining_table->time_to_sleep);
+	release_forks(philosopher);
+	update_realtime_priority(philosopher);
+	philosopher_sleep(philosopher, duration);
 }
 
 /* think_routine:
  *   Once a philosopher is done sleeping, he will think for a certain
  *   amount of time before starting to eat again. The time_to_think is
  *   calculated depending on how long it has been since the philosopher's
- *   last meal, the time_to_eat, and the time_to_die to determine when the
+ *   last meal, and his own time_to_eat and time_to_die, to determine when the
  *   philosopher will be hungry again. This helps stagger philosopher's
  *   eating routines to avoid forks being needlessly monopolized by one
- *   philosopher to the detriment of others.
+ *   philosopher to the detriment of others. He comes back think_slack_ms
+ *   early, to make up for the host's late wakeups (see calibrate). Once
+ *   the simulation has stopped, he keeps the phase he was in for the
+ *   last checkpoint.
  *
  *   Parameters:
  *     - philosopher: Pointer to the philosopher structure.
@@ -67,10 +91,14 @@ static void	think_routine(t_philosopher *philosopher, bool silent)
 {
 	time_t	time_to_think;
 
+	profile_transition(philosopher, STATE_THINKING);
 	pthread_mutex_lock(&philosopher->last_meal_lock);
-	time_to_think = (philosopher->dining_table->time_to_die
+	time_to_think = (PHILO_TIME_TO_DIE(philosopher)
 			- (get_current_time_in_ms() - philosopher->last_meal_time)
-			- philosopher->dining_table->time_to_eat) / 2;
+			- PHILO_TIME_TO_EAT(philosopher)) / 2
+		- philosopher->dining_table->settings.think_slack_ms;
+	if (!is_simulation_stopped(philosopher->dining_table))
+		record_phase(philosopher, PHILO_THINKING, 0);
 	pthread_mutex_unlock(&philosopher->last_meal_lock);
 	if (time_to_think < 0)
 		time_to_think = 0;
@@ -80,7 +108,65 @@ static void	think_routine(t_philosopher *philosopher, bool silent)
 		time_to_think = 200;
 	if (!silent)
 		philo_stat(philosopher, false, PHILO_THINKING);
-	philosopher_sleep(philosopher->dining_table, time_to_think);
+	philosopher_sleep(philosopher, time_to_think);
+}
+
+/* scheduled_routine:
+ *   The routine followed with the static schedule. Instead of guessing
+ *   how long to think, the philosopher waits for his own slot of the
+ *   schedule planned at initialization (see plan_schedule), on the
+ *   absolute clock. Since neighbors never have overlapping slots, the
+ *   forks are always free when he takes them: the fork locks are only
+ *   kept as a safety net if a neighbor runs late.
+ *
+ *   Parameters:
+ *     - philosopher: Pointer to the philosopher structure.
+ */
+static void	scheduled_routine(t_philosopher *philosopher)
+{
+	t_schedule	*schedule;
+	uint64_t	next_meal;
+
+	schedule = &philosopher->dining_table->schedule;
+	next_meal = (uint64_t)philosopher->dining_table->start_time * 1000000
+		+ schedule_offset(schedule, philosopher->id);
+	philosopher_sleep_until(philosopher, next_meal);
+	while (!is_simulation_stopped(philosopher->dining_table))
+	{
+		eat_and_sleep_routine(philosopher, false);
+		profile_transition(philosopher, STATE_THINKING);
+		philo_stat(philosopher, false, PHILO_THINKING);
+		next_meal += schedule->period_ns;
+		philosopher_sleep_until(philosopher, next_meal);
+	}
+}
+
+/* resumed_routine:
+ *   Picks a philosopher's routine back up where a checkpoint left it
+ *   (see resume_checkpoint): if he was eating, he takes his forks back
+ *   at once and finishes his meal; if he was sleeping, he finishes his
+ *   nap; and if he was thinking, he thinks for as long as his restored
+ *   last meal allows, silently, like at the start.
+ *
+ *   Parameters:
+ *     - philosopher: Pointer to the philosopher structure.
+ */
+static void	resumed_routine(t_philosopher *philosopher)
+{
+	unsigned int	status;
+
+	status = atomic_load_explicit(&philosopher->phase.status,
+			memory_order_relaxed);
+	if (status == PHILO_EATING)
+		eat_and_sleep_routine(philosopher, true);
+	else if (status == PHILO_SLEEPING)
+	{
+		profile_transition(philosopher, STATE_SLEEPING);
+		philosopher_sleep(philosopher, atomic_load_explicit(
+				&philosopher->phase.end, memory_order_relaxed)
+			- get_current_time_in_ms());
+	}
+	think_routine(philosopher, status == PHILO_THINKING);
 }
 
 /* lone_philosopher_routine:
@@ -93,17 +179,21 @@ static void	think_routine(t_philosopher *philosopher, bool silent)
  *   Parameters:
  *     - philosopher: Pointer to the philosopher structure.
  */
-static void	*lone_philosopher_routine(t_philosopher *philosopher)
+static void	lone_philosopher_routine(t_philosopher *philosopher)
 {
-	pthread_mutex_lock(&philosopher->dining_table->\
-	fork_locks[philosopher->fork[0]]);
-	philo_stat(philosopher, false, PHILO_GOT_FORK_1);
-	philosopher_sleep(philosopher->dining_table,
-		philosopher->dining_table->time_to_die);
+	profile_transition(philosopher, STATE_FIRST_FORK);
+	trace_before(philosopher, TRACE_FORK, 0);
+	fork_lock_acquire(&philosopher->dining_table->\
+	fork_locks[philosopher->forks[0]], &philosopher->fork_nodes[0]);
+	trace_after(philosopher, TRACE_FORK, 0);
+	profile_transition(philosopher, STATE_OTHER_FORKS);
+	philosopher->forks_held = 1;
+	philo_stat(philosopher, false, PHILO_GOT_FORK);
+	philosopher_sleep(philosopher, PHILO_TIME_TO_DIE(philosopher));
+	philosopher->died = !is_simulation_stopped(philosopher->dining_table);
 	philo_stat(philosopher, false, PHILO_DIED);
-	pthread_mutex_unlock(&philosopher->dining_table->\
-	fork_locks[philosopher->fork[0]]);
-	return (NULL);
+	fork_lock_release(&philosopher->dining_table->\
+	fork_locks[philosopher->forks[0]], &philosopher->fork_nodes[0]);
 }
 
 /* philosopher_routine:
@@ -111,7 +201,9 @@ static void	*lone_philosopher_routine(t_philosopher *philosopher)
  *   and think. In order to avoid conflicts between philosopher threads,
  *   philosophers with an even id start by thinking, which delays their
  *   meal time by a small margin. This allows odd-id philosophers to
- *   grab their forks first, avoiding deadlocks.
+ *   grab their forks first, avoiding deadlocks. The static schedule or
+ *   a checkpoint, if any, decides where he starts instead. He returns
+ *   once the simulation stops or he leaves the table.
  *
  *   Parameters:
  *     - data: Pointer to the philosopher structure.
@@ -124,22 +216,35 @@ void	*philosopher_routine(void *data)
 	t_philosopher	*philosopher;
 
 	philosopher = (t_philosopher *)data;
-	if (philosopher->dining_table->must_eat_count == 0)
+	if (TABLE_MUST_EAT(philosopher->dining_table) == 0)
 		return (NULL);
 	pthread_mutex_lock(&philosopher->last_meal_lock);
-	philosopher->last_meal_time = philosopher->dining_table->start_time;
+	if (philosopher->last_meal_time == 0)
+		philosopher->last_meal_time = philosopher->dining_table->start_time;
 	pthread_mutex_unlock(&philosopher->last_meal_lock);
+	philosopher->realtime_level = -1;
 	delay_simulation_start(philosopher->dining_table->start_time);
-	if (philosopher->dining_table->time_to_die == 0)
+	if (PHILO_TIME_TO_DIE(philosopher) == 0)
 		return (NULL);
-	if (philosopher->dining_table->num_philosophers == 1)
-		return (lone_philosopher_routine(philosopher));
-	else if (philosopher->id % 2)
+	update_realtime_priority(philosopher);
+	profile_start(philosopher);
+	if (TABLE_PHILOSOPHERS(philosopher->dining_table) == 1)
+		lone_philosopher_routine(philosopher);
+	else if (philosopher->dining_table->settings.schedule == SCHEDULE_STATIC)
+		scheduled_routine(philosopher);
+	else if (philosopher->dining_table->checkpoint.resumed)
+		resumed_routine(philosopher);
+	else if (philosopher->id % 2
+		|| philosopher->id >= philosopher->dining_table->num_philosophers)
 		think_routine(philosopher, true);
-	while (!is_simulation_stopped(philosopher->dining_table))
+	while (TABLE_PHILOSOPHERS(philosopher->dining_table) > 1
+		&& philosopher->dining_table->settings.schedule == SCHEDULE_DYNAMIC
+		&& !is_simulation_stopped(philosopher->dining_table)
+		&& !atomic_load_explicit(&philosopher->leaving, memory_order_relaxed))
 	{
-		eat_and_sleep_routine(philosopher);
+		eat_and_sleep_routine(philosopher, false);
 		think_routine(philosopher, false);
 	}
+	profile_transition(philosopher, philosopher->profile.state);
 	return (NULL);
 }
@@ -0,0 +1,116 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   profile.c                                          :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: antestem <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/07/11 17:01:20 by antestem          #+#    #+#             */
+/*   Updated: 2024/07/11 17:01:21 by antestem         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "philosophers.h"
+
+/* monotonic_ns:
+ *   Returns the monotonic clock in nanoseconds. Unlike the timestamps
+ *   of the output, the profile must not jump if the wall clock is set.
+ */
+static uint64_t	monotonic_ns(void)
+{
+	struct timespec	ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec);
+}
+
+/* profile_start:
+ *   Starts counting the philosopher's time, in the thinking state,
+ *   once the simulation has started.
+ *
+ *   Parameters:
+ *     - philosopher: Pointer to the philosopher structure.
+ */
+void	profile_start(t_philosopher *philosopher)
+{
+	PROBE_TRANSITION(philosopher->id + 1, STATE_THINKING);
+	if (philosopher->dining_table->settings.profile != PROFILE_STATES)
+		return ;
+	philosopher->profile.state = STATE_THINKING;
+	philosopher->profile.since = monotonic_ns();
+}
+
+/* profile_transition:
+ *   Adds the time since the last transition to the philosopher's
+ *   current state, then moves him to a new state. Moving to the current
+ *   state just brings its time up to date.
+ *
+ *   Parameters:
+ *     - philosopher: Pointer to the philosopher structure.
+ *     - state: The state the philosopher is entering.
+ */
+void	profile_transition(t_philosopher *philosopher, t_profile_state state)
+{
+	uint64_t	now;
+
+	PROBE_TRANSITION(philosopher->id + 1, state);
+	if (philosopher->dining_table->settings.profile != PROFILE_STATES)
+		return ;
+	now = monotonic_ns();
+	philosopher->profile.time_ns[philosopher->profile.state]
+		+= now - philosopher->profile.since;
+	philosopher->profile.state = state;
+	philosopher->profile.since = now;
+}
+
+/* profile_overhead_start:
+ *   Marks the start of a call made for the simulator rather than the
+ *   philosopher, such as printing a status or checking whether the
+ *   simulation stopped.
+ *
+ *   Parameters:
+ *     - philosopher: Pointer to the philosopher structure.
+ *
+ *   Returns:
+ *     - The time to pass to profile_overhead_end, or 0 if the profile
+ *       is off.
+ */
+uint64_t	profile_overhead_start(t_philosopher *philosopher)
+{
+	if (philosopher->dining_table->settings.profile != PROFILE_STATES)
+		return (0);
+	return (monotonic_ns());
+}
+
+/* profile_overhead_end:
+ *   Counts the time since profile_overhead_start as overhead instead of
+ *   as part of the philosopher's current state.
+ *
+ *   Parameters:
+ *     - philosopher: Pointer to the philosopher structure.
+ *     - start: The time returned by profile_overhead_start.
+ */
+void	profile_overhead_end(t_philosopher *philosopher, uint64_t start)
+{
+	uint64_t	elapsed;
+
+	if (start == 0)
+		return ;
+	elapsed = monotonic_ns() - start;
+	philosopher->profile.time_ns[STATE_OVERHEAD] += elapsed;
+	philosopher->profile.since += elapsed;
+}
+
+/* profile_probe:
+ *   The probe of probe builds without <sys/sdt.h>. It does nothing, but
+ *   is never inlined, so that a uprobe on it sees every transition:
+ *     perf probe -x ./philo profile_probe id state
+ *
+ *   Parameters:
+ *     - id: The number of the philosopher, from 1.
+ *     - state: The state he is entering (see t_profile_state).
+ */
+__attribute__((noinline)) void	profile_probe(unsigned int id, int state)
+{
+	__asm__ __volatile__ ("" : : "r" (id), "r" (state) : "memory");
+}
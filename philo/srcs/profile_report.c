@@ -0,0 +1,159 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   profile_report.c                                   :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: antestem <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/07/11 17:01:22 by antestem          #+#    #+#             */
+/*   Updated: 2024/07/11 17:01:23 by antestem         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "philosophers.h"
+
+/* print_profile_row:
+ *   Prints one row of the profile table: a number of meals and the
+ *   time spent in each state, in milliseconds.
+ *
+ *   Parameters:
+ *     - name: The first column, a philosopher number or "all".
+ *     - meals: The number of meals.
+ *     - time_ns: The time spent in each state, in nanoseconds.
+ */
+static void	print_profile_row(char *name, unsigned long meals,
+		uint64_t *time_ns)
+{
+	int	state;
+
+	fprintf(stderr, "profile: %-5s %7lu", name, meals);
+	state = 0;
+	while (state < NUM_STATES)
+		fprintf(stderr, " %11.1f", time_ns[state++] / 1e6);
+	fprintf(stderr, "\n");
+}
+
+/* max_concurrent_meals:
+ *   Returns how many philosophers can eat at the same time at most:
+ *   each meal needs at least as many forks as the philosopher who needs
+ *   the fewest, and no fork can serve two meals. On the default ring,
+ *   this is half of the philosophers, rounded down.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ *
+ *   Returns:
+ *     - The number of meals that can happen at once, or 0 if the table
+ *       has fewer forks than a meal needs, as for a lone philosopher.
+ */
+static unsigned int	max_concurrent_meals(t_dining_table *dining_table)
+{
+	unsigned int	i;
+	unsigned int	min_forks;
+	unsigned int	meals;
+
+	min_forks = UINT_MAX;
+	i = 0;
+	while (i < dining_table->num_philosophers)
+	{
+		if (dining_table->philosophers[i]->num_forks < min_forks)
+			min_forks = dining_table->philosophers[i]->num_forks;
+		i++;
+	}
+	if (min_forks == 0)
+		min_forks = 1;
+	meals = dining_table->num_forks / min_forks;
+	if (meals > dining_table->num_philosophers)
+		meals = dining_table->num_philosophers;
+	return (meals);
+}
+
+/* print_schedule_comparison:
+ *   Compares the time the philosophers spent in each kind of state with
+ *   the best schedule the table allows, in which every philosopher
+ *   starts a meal once per cycle. The cycle can be no shorter than a
+ *   meal and a nap, nor than the time needed for every philosopher to
+ *   eat when only max_concurrent_meals meals fit at once. The rest of
+ *   the cycle is waiting, which the ideal schedule spends thinking.
+ *   Any extra waiting or overhead is time lost to the forks and to the
+ *   simulator.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ *     - total: The time spent in each state by all philosophers.
+ */
+static void	print_schedule_comparison(t_dining_table *dining_table,
+		uint64_t *total)
+{
+	double			cycle;
+	double			all;
+	double			waiting;
+	int				state;
+	unsigned int	meals;
+
+	meals = max_concurrent_meals(dining_table);
+	if (meals == 0)
+	{
+		fprintf(stderr, "profile: no schedule lets a philosopher eat\n");
+		return ;
+	}
+	cycle = (double)dining_table->time_to_eat * dining_table->num_philosophers
+		/ meals;
+	if (cycle < dining_table->time_to_eat + dining_table->time_to_sleep)
+		cycle = dining_table->time_to_eat + dining_table->time_to_sleep;
+	all = 0;
+	state = 0;
+	while (state < NUM_STATES)
+		all += total[state++];
+	if (all == 0 || cycle == 0)
+		return ;
+	waiting = total[STATE_THINKING] + total[STATE_FIRST_FORK]
+		+ total[STATE_OTHER_FORKS];
+	fprintf(stderr, "profile: ideal cycle %.1f ms: eating %.1f%% "
+		"(ideal %.1f%%), waiting %.1f%% (ideal %.1f%%, forks %.1f%%), "
+		"overhead %.1f%%\n", cycle, total[STATE_EATING] * 100 / all,
+		dining_table->time_to_eat * 100 / cycle, waiting * 100 / all,
+		(cycle - dining_table->time_to_eat - dining_table->time_to_sleep)
+		* 100 / cycle, (total[STATE_FIRST_FORK] + total[STATE_OTHER_FORKS])
+		* 100 / all, total[STATE_OVERHEAD] * 100 / all);
+}
+
+/* print_profile_report:
+ *   Prints on the standard error where each philosopher's time went
+ *   with the "states" profile, in milliseconds, then the total over all
+ *   philosophers and how it compares with the ideal schedule.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure, whose
+ *       philosopher threads have all been joined.
+ */
+void	print_profile_report(t_dining_table *dining_table)
+{
+	uint64_t		total[NUM_STATES];
+	unsigned long	meals;
+	unsigned int	i;
+	int				state;
+	char			name[12];
+
+	if (dining_table->settings.profile != PROFILE_STATES)
+		return ;
+	memset(total, 0, sizeof(total));
+	meals = 0;
+	fprintf(stderr, "profile: philo   meals    thinking  first_fork "
+		"other_forks      eating    sleeping    overhead\n");
+	i = 0;
+	while (i < dining_table->num_philosophers)
+	{
+		snprintf(name, sizeof(name), "%u", i + 1);
+		print_profile_row(name, dining_table->philosophers[i]->times_ate,
+			dining_table->philosophers[i]->profile.time_ns);
+		meals += dining_table->philosophers[i]->times_ate;
+		state = -1;
+		while (++state < NUM_STATES)
+			total[state]
+				+= dining_table->philosophers[i]->profile.time_ns[state];
+		i++;
+	}
+	print_profile_row("all", meals, total);
+	print_schedule_comparison(dining_table, total);
+}
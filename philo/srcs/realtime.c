@@ -0,0 +1,103 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   realtime.c                                         :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: antestem <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/07/11 17:01:54 by antestem          #+#    #+#             */
+/*   Updated: 2024/07/11 17:01:55 by antestem         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "philosophers.h"
+
+/* check_realtime:
+ *   With the "fifo" real-time mode, checks before any thread starts that
+ *   this process may use SCHED_FIFO up to the reaper's priority, by
+ *   trying it on the calling thread then putting it back. Without the
+ *   privilege (root, CAP_SYS_NICE or a high enough RLIMIT_RTPRIO), it
+ *   warns and the run goes on without the real-time mode.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ */
+void	check_realtime(t_dining_table *dining_table)
+{
+	struct sched_param	saved;
+	struct sched_param	param;
+	int					policy;
+	int					error;
+
+	if (dining_table->settings.realtime == REALTIME_OFF)
+		return ;
+	error = pthread_getschedparam(pthread_self(), &policy, &saved);
+	param.sched_priority = sched_get_priority_min(SCHED_FIFO)
+		+ REALTIME_LEVELS;
+	if (error == 0)
+		error = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+	if (error == 0)
+	{
+		pthread_setschedparam(pthread_self(), policy, &saved);
+		return ;
+	}
+	print_message(WARNING_REALTIME, strerror(error), 0);
+	dining_table->settings.realtime = REALTIME_OFF;
+}
+
+/* set_realtime_priority:
+ *   Moves the calling thread to SCHED_FIFO, at one of the levels above
+ *   the lowest real-time priority: 0 to REALTIME_LEVELS - 1 for the
+ *   philosophers, REALTIME_LEVELS for the grim reaper, so that it
+ *   preempts all of them. Every level is above the threads of the
+ *   normal policy, such as a busy host's.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ *     - level: The level of the thread.
+ *
+ *   Returns:
+ *     - A boolean indicating whether the priority was set. It is never
+ *       set without the real-time mode.
+ */
+bool	set_realtime_priority(t_dining_table *dining_table, int level)
+{
+	struct sched_param	param;
+
+	if (dining_table->settings.realtime == REALTIME_OFF)
+		return (false);
+	param.sched_priority = sched_get_priority_min(SCHED_FIFO) + level;
+	return (pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0);
+}
+
+/* update_realtime_priority:
+ *   Orders the philosophers by deadline in the real-time mode: the less
+ *   slack a philosopher has left before time_to_die, the higher his
+ *   priority, so that the hungriest one runs first when several are
+ *   ready, and is woken first among the waiters of a fork lock. He
+ *   updates it himself once the simulation starts, not during the wait
+ *   for the start, which spins, then as he reaches for his forks and
+ *   puts them down, and only calls the scheduler when his level changes.
+ *
+ *   Parameters:
+ *     - philosopher: Pointer to the philosopher structure.
+ */
+void	update_realtime_priority(t_philosopher *philosopher)
+{
+	time_t	hunger;
+	int		level;
+
+	if (philosopher->dining_table->settings.realtime == REALTIME_OFF)
+		return ;
+	pthread_mutex_lock(&philosopher->last_meal_lock);
+	hunger = get_current_time_in_ms() - philosopher->last_meal_time;
+	pthread_mutex_unlock(&philosopher->last_meal_lock);
+	level = 0;
+	if (hunger > 0 && PHILO_TIME_TO_DIE(philosopher) > 0)
+		level = hunger * REALTIME_LEVELS / PHILO_TIME_TO_DIE(philosopher);
+	if (level >= REALTIME_LEVELS)
+		level = REALTIME_LEVELS - 1;
+	if (level != philosopher->realtime_level
+		&& set_realtime_priority(philosopher->dining_table, level))
+		philosopher->realtime_level = level;
+}
@@ -0,0 +1,79 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   schedule.c                                         :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: antestem <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/07/11 17:01:24 by antestem          #+#    #+#             */
+/*   Updated: 2024/07/11 17:01:25 by antestem         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "philosophers.h"
+
+/* plan_schedule:
+ *   Finds the shortest periodic schedule in which every philosopher
+ *   eats once per period without ever waiting for a fork. It is only
+ *   planned for the default ring of forks with at least two
+ *   philosophers who all share the same timings: a lone philosopher has
+ *   a single fork and can never eat.
+ *
+ *   With an even number of philosophers, neighbors take turns: the
+ *   period is two meals. With an odd number 2k + 1, at most k
+ *   philosophers can eat at once, so the period is at least
+ *   (2k + 1) / k meals. A circular coloring reaches that bound: the
+ *   period is split into 2k + 1 slots, a meal lasts k of them, and
+ *   each philosopher starts k slots after his left neighbor.
+ *   In both cases the period can be no shorter than a meal and a nap.
+ *   The schedule is survivable if a philosopher starts eating again
+ *   before time_to_die has passed since his last meal started.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ */
+void	plan_schedule(t_dining_table *dining_table)
+{
+	t_schedule	*schedule;
+	uint64_t	min_period;
+
+	schedule = &dining_table->schedule;
+	memset(schedule, 0, sizeof(t_schedule));
+	if (dining_table->settings.topology || dining_table->settings.timings
+		|| dining_table->num_philosophers < 2)
+		return ;
+	schedule->exists = true;
+	schedule->num_slots = 2;
+	schedule->slots_per_meal = 1;
+	if (dining_table->num_philosophers % 2)
+	{
+		schedule->num_slots = dining_table->num_philosophers;
+		schedule->slots_per_meal = dining_table->num_philosophers / 2;
+	}
+	schedule->slot_ns = ((uint64_t)dining_table->time_to_eat * 1000000
+			+ schedule->slots_per_meal - 1) / schedule->slots_per_meal;
+	schedule->period_ns = schedule->num_slots * schedule->slot_ns;
+	min_period = (uint64_t)(dining_table->time_to_eat
+			+ dining_table->time_to_sleep) * 1000000;
+	if (schedule->period_ns < min_period)
+		schedule->period_ns = min_period;
+	schedule->survivable = (schedule->period_ns
+			< (uint64_t)dining_table->time_to_die * 1000000);
+}
+
+/* schedule_offset:
+ *   Returns when a philosopher starts eating in each period of the
+ *   schedule.
+ *
+ *   Parameters:
+ *     - schedule: Pointer to a schedule that exists.
+ *     - id: The id of the philosopher, from 0.
+ *
+ *   Returns:
+ *     - The time from the start of the period, in nanoseconds.
+ */
+uint64_t	schedule_offset(t_schedule *schedule, unsigned int id)
+{
+	return ((uint64_t)id * schedule->slots_per_meal % schedule->num_slots
+		* schedule->slot_ns);
+}
@@ -0,0 +1,236 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   settings.c                                         :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: antestem <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/07/11 16:59:35 by antestem          #+#    #+#             */
+/*   Updated: 2024/07/11 16:59:36 by antestem         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "philosophers.h"
+
+/* init_default_settings:
+ *   Fills the settings with their defaults. The simulation parameters
+ *   start unset (-1) and must be given by a preset, the config file,
+ *   the environment or the command line.
+ *
+ *   Parameters:
+ *     - settings: Pointer to the settings structure.
+ */
+void	init_default_settings(t_settings *settings)
+{
+	memset(settings, 0, sizeof(t_settings));
+	settings->num_philosophers = -1;
+	settings->time_to_die = -1;
+	settings->time_to_eat = -1;
+	settings->time_to_sleep = -1;
+	settings->must_eat_count = -1;
+	settings->max_philosophers = MAX_PHILOSOPHERS;
+	settings->sleep_granularity_us = SLEEP_GRANULARITY_US;
+	settings->reaper_interval_us = REAPER_INTERVAL_US;
+	settings->noise_seed = 1;
+	settings->flush_interval_us = OUTPUT_FLUSH_US;
+	settings->stack_size_kb = STACK_SIZE_KB;
+	settings->jitter_seed = 1;
+	settings->churn_seed = 1;
+	settings->checkpoint_interval_ms = CHECKPOINT_INTERVAL_MS;
+	settings->calibration_ms = CALIBRATION_MS;
+	settings->output_mode = OUTPUT_PLAIN;
+	if (DEBUG_FORMATTING)
+		settings->output_mode = OUTPUT_DEBUG;
+	settings->fork_acquisition = FORK_BLOCKING;
+	settings->pinning = PIN_NONE;
+	settings->profile = PROFILE_OFF;
+	settings->oracle = ORACLE_OFF;
+	settings->schedule = SCHEDULE_DYNAMIC;
+	settings->footprint = FOOTPRINT_DEFAULT;
+	settings->realtime = REALTIME_OFF;
+}
+
+/* number_setting:
+ *   Finds the field of a numeric setting.
+ *
+ *   Parameters:
+ *     - settings: Pointer to the settings structure.
+ *     - key: The name of the setting.
+ *
+ *   Returns:
+ *     - A pointer to the field, or NULL if the key is not numeric.
+ */
+static int	*number_setting(t_settings *settings, char *key)
+{
+	if (strcmp(key, "philosophers") == 0)
+		return (&settings->num_philosophers);
+	if (strcmp(key, "time_to_die") == 0)
+		return (&settings->time_to_die);
+	if (strcmp(key, "time_to_eat") == 0)
+		return (&settings->time_to_eat);
+	if (strcmp(key, "time_to_sleep") == 0)
+		return (&settings->time_to_sleep);
+	if (strcmp(key, "must_eat") == 0)
+		return (&settings->must_eat_count);
+	if (strcmp(key, "max_philosophers") == 0)
+		return (&settings->max_philosophers);
+	if (strcmp(key, "sleep_granularity_us") == 0)
+		return (&settings->sleep_granularity_us);
+	if (strcmp(key, "reaper_interval_us") == 0)
+		return (&settings->reaper_interval_us);
+	if (strcmp(key, "noise_seed") == 0)
+		return (&settings->noise_seed);
+	if (strcmp(key, "noise_max_us") == 0)
+		return (&settings->noise_max_us);
+	if (strcmp(key, "flush_interval_us") == 0)
+		return (&settings->flush_interval_us);
+	if (strcmp(key, "processes") == 0)
+		return (&settings->processes);
+	if (strcmp(key, "stack_size_kb") == 0)
+		return (&settings->stack_size_kb);
+	if (strcmp(key, "jitter_seed") == 0)
+		return (&settings->jitter_seed);
+	if (strcmp(key, "churn_interval_us") == 0)
+		return (&settings->churn_interval_us);
+	if (strcmp(key, "churn_seed") == 0)
+		return (&settings->churn_seed);
+	if (strcmp(key, "checkpoint_interval_ms") == 0)
+		return (&settings->checkpoint_interval_ms);
+	if (strcmp(key, "sleep_spin_us") == 0)
+		return (&settings->sleep_spin_us);
+	if (strcmp(key, "think_slack_ms") == 0)
+		return (&settings->think_slack_ms);
+	if (strcmp(key, "calibration_ms") == 0)
+		return (&settings->calibration_ms);
+	return (NULL);
+}
+
+/* string_setting:
+ *   Finds the field of a setting holding a file path or a name.
+ *
+ *   Parameters:
+ *     - settings: Pointer to the settings structure.
+ *     - key: The name of the setting.
+ *
+ *   Returns:
+ *     - A pointer to the field, or NULL if the key is not a string.
+ */
+static char	**string_setting(t_settings *settings, char *key)
+{
+	if (strcmp(key, "preset") == 0)
+		return (&settings->preset);
+	if (strcmp(key, "topology") == 0)
+		return (&settings->topology);
+	if (strcmp(key, "timings") == 0)
+		return (&settings->timings);
+	if (strcmp(key, "record") == 0)
+		return (&settings->record);
+	if (strcmp(key, "replay") == 0)
+		return (&settings->replay);
+	if (strcmp(key, "checkpoint") == 0)
+		return (&settings->checkpoint);
+	if (strcmp(key, "resume") == 0)
+		return (&settings->resume);
+	if (strcmp(key, "calibration") == 0)
+		return (&settings->calibration);
+	return (NULL);
+}
+
+/* apply_choice_setting:
+ *   Sets one of the mode settings, whose value must be one of a list
+ *   of choices.
+ *
+ *   Parameters:
+ *     - settings: Pointer to the settings structure.
+ *     - key: The name of the setting.
+ *     - value: The value of the setting.
+ *
+ *   Returns:
+ *     - A boolean indicating whether the key and value are valid.
+ */
+static bool	apply_choice_setting(t_settings *settings, char *key,
+		char *value)
+{
+	int	choice;
+
+	if (strcmp(key, "output") == 0)
+		choice = parse_choice(value, OUTPUT_CHOICES);
+	else if (strcmp(key, "acquisition") == 0)
+		choice = parse_choice(value, ACQUISITION_CHOICES);
+	else if (strcmp(key, "pinning") == 0)
+		choice = parse_choice(value, PINNING_CHOICES);
+	else if (strcmp(key, "writer") == 0)
+		choice = parse_choice(value, WRITER_CHOICES);
+	else if (strcmp(key, "output_io") == 0)
+		choice = parse_choice(value, OUTPUT_IO_CHOICES);
+	else if (strcmp(key, "profile") == 0)
+		choice = parse_choice(value, PROFILE_CHOICES);
+	else if (strcmp(key, "oracle") == 0)
+		choice = parse_choice(value, ORACLE_CHOICES);
+	else if (strcmp(key, "schedule") == 0)
+		choice = parse_choice(value, SCHEDULE_CHOICES);
+	else if (strcmp(key, "footprint") == 0)
+		choice = parse_choice(value, FOOTPRINT_CHOICES);
+	else if (strcmp(key, "realtime") == 0)
+		choice = parse_choice(value, REALTIME_CHOICES);
+	else
+		return (print_message(ERROR_UNKNOWN_SETTING, key, false));
+	if (choice < 0)
+		return (print_message(ERROR_INVALID_SETTING, key, false));
+	if (strcmp(key, "output") == 0)
+		settings->output_mode = choice;
+	else if (strcmp(key, "acquisition") == 0)
+		settings->fork_acquisition = choice;
+	else if (strcmp(key, "pinning") == 0)
+		settings->pinning = choice;
+	else if (strcmp(key, "writer") == 0)
+		settings->writer = choice;
+	else if (strcmp(key, "output_io") == 0)
+		settings->output_io = choice;
+	else if (strcmp(key, "profile") == 0)
+		settings->profile = choice;
+	else if (strcmp(key, "oracle") == 0)
+		settings->oracle = choice;
+	else if (strcmp(key, "schedule") == 0)
+		settings->schedule = choice;
+	else if (strcmp(key, "footprint") == 0)
+		settings->footprint = choice;
+	else
+		settings->realtime = choice;
+	return (true);
+}
+
+/* apply_setting:
+ *   Sets one setting from its textual value. Numbers must be unsigned
+ *   integers, modes must be one of their listed choices, and paths or
+ *   names are copied as is.
+ *
+ *   Parameters:
+ *     - settings: Pointer to the settings structure.
+ *     - key: The name of the setting.
+ *     - value: The value of the setting.
+ *
+ *   Returns:
+ *     - A boolean indicating whether the key and value are valid.
+ */
+bool	apply_setting(t_settings *settings, char *key, char *value)
+{
+	char	**field;
+
+	if (number_setting(settings, key))
+	{
+		if (!parse_unsigned(value, number_setting(settings, key)))
+			return (print_message(ERROR_INVALID_SETTING, key, false));
+		return (true);
+	}
+	field = string_setting(settings, key);
+	if (field)
+	{
+		free(*field);
+		*field = strdup(value);
+		if (!*field)
+			return (print_message(ERROR_MEMORY_ALLOCATION, NULL, false));
+		return (true);
+	}
+	return (apply_choice_setting(settings, key, value));
+}
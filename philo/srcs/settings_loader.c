@@ -0,0 +1,193 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   settings_loader.c                                  :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: antestem <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/07/11 17:00:06 by antestem          #+#    #+#             */
+/*   Updated: 2024/07/11 17:00:07 by antestem         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "philosophers.h"
+
+extern char	**environ;
+
+/* apply_environment:
+ *   Applies every PHILO_<KEY> environment variable as the setting <key>,
+ *   for example PHILO_TIME_TO_DIE=410 or PHILO_OUTPUT=debug. PHILO_CONFIG
+ *   and PHILO_PRESET are handled separately.
+ *
+ *   Parameters:
+ *     - settings: Pointer to the settings structure.
+ *
+ *   Returns:
+ *     - A boolean indicating whether all variables are valid settings.
+ */
+static bool	apply_environment(t_settings *settings)
+{
+	char	key[64];
+	char	**variable;
+	char	*name;
+	char	*value;
+	size_t	i;
+
+	variable = environ;
+	while (*variable)
+	{
+		name = *variable++;
+		value = strchr(name, '=');
+		if (strncmp(name, SETTING_ENV_PREFIX, strlen(SETTING_ENV_PREFIX))
+			|| !value || strncmp(name, CONFIG_ENV "=", strlen(CONFIG_ENV) + 1)
+			== 0 || strncmp(name, PRESET_ENV "=", strlen(PRESET_ENV) + 1) == 0)
+			continue ;
+		name += strlen(SETTING_ENV_PREFIX);
+		i = 0;
+		while (name + i < value && i < sizeof(key) - 1)
+		{
+			key[i] = tolower(name[i]);
+			i++;
+		}
+		key[i] = '\0';
+		if (!apply_setting(settings, key, value + 1))
+			return (false);
+	}
+	return (true);
+}
+
+/* apply_arguments:
+ *   Applies the simulation parameters given on the command line, which
+ *   take precedence over every other source. The arguments can be left
+ *   out entirely when other sources give the parameters.
+ *
+ *   Parameters:
+ *     - settings: Pointer to the settings structure.
+ *     - argc: The number of command-line arguments.
+ *     - argv: The array of command-line arguments.
+ *
+ *   Returns:
+ *     - A boolean indicating whether the arguments are valid.
+ */
+static bool	apply_arguments(t_settings *settings, int argc, char **argv)
+{
+	if (argc - 1 == 0)
+		return (true);
+	if (argc - 1 < 4 || argc - 1 > 5)
+		return (print_message(USAGE_MESSAGE, NULL, false));
+	if (!is_valid_input(argc, argv))
+		return (false);
+	settings->num_philosophers = parse_integer(argv[1]);
+	settings->time_to_die = parse_integer(argv[2]);
+	settings->time_to_eat = parse_integer(argv[3]);
+	settings->time_to_sleep = parse_integer(argv[4]);
+	if (argc - 1 == 5)
+		settings->must_eat_count = parse_integer(argv[5]);
+	return (true);
+}
+
+/* validate_settings:
+ *   Checks that every simulation parameter was given and that the
+ *   settings are consistent with each other. The reaper and the sleeps
+ *   must pause between their checks, or they would spin on usleep(0).
+ *
+ *   Parameters:
+ *     - settings: Pointer to the settings structure.
+ *
+ *   Returns:
+ *     - A boolean indicating whether the settings are usable.
+ */
+static bool	validate_settings(t_settings *settings)
+{
+	char	limit[16];
+
+	if (settings->num_philosophers < 0 || settings->time_to_die < 0
+		|| settings->time_to_eat < 0 || settings->time_to_sleep < 0)
+		return (print_message(USAGE_MESSAGE, NULL, false));
+	if (settings->max_philosophers > PHILOSOPHERS_LIMIT)
+		return (print_message(ERROR_INVALID_SETTING, "max_philosophers",
+				false));
+	if (settings->reaper_interval_us < REAPER_MIN_INTERVAL_US)
+		return (print_message(ERROR_INVALID_SETTING, "reaper_interval_us",
+				false));
+	if (settings->sleep_granularity_us < 1)
+		return (print_message(ERROR_INVALID_SETTING, "sleep_granularity_us",
+				false));
+	snprintf(limit, sizeof(limit), "%d", settings->max_philosophers);
+	if (settings->num_philosophers == 0
+		|| settings->num_philosophers > settings->max_philosophers)
+		return (print_message(ERROR_INVALID_INPUT_RANGE, limit, false));
+	if (settings->record && settings->replay)
+		return (print_message(ERROR_TRACE_MODE, NULL, false));
+	return (true);
+}
+
+/* load_settings:
+ *   Loads the settings from every source. Later sources override
+ *   earlier ones:
+ *     1. the defaults, set by init_default_settings;
+ *     2. the top level of the config file named by PHILO_CONFIG;
+ *     3. the presets named by PHILO_PRESET, or else by the config
+ *        file's "preset" key: each is a built-in preset and/or a
+ *        section of the config file;
+ *     4. PHILO_<KEY> environment variables;
+ *     5. the command-line arguments.
+ *
+ *   Parameters:
+ *     - settings: Pointer to the default settings.
+ *     - argc: The number of command-line arguments.
+ *     - argv: The array of command-line arguments.
+ *
+ *   Returns:
+ *     - A boolean indicating whether the settings are valid.
+ */
+bool	load_settings(t_settings *settings, int argc, char **argv)
+{
+	char	*config_text;
+	bool	success;
+
+	config_text = NULL;
+	if (getenv(CONFIG_ENV))
+	{
+		config_text = read_text_file(getenv(CONFIG_ENV));
+		if (!config_text)
+			return (print_message(ERROR_CONFIG_FILE, getenv(CONFIG_ENV),
+					false));
+	}
+	success = !config_text
+		|| apply_config_text(settings, config_text, NULL, NULL);
+	if (success && getenv(PRESET_ENV))
+		success = apply_setting(settings, "preset", getenv(PRESET_ENV));
+	if (success && settings->preset)
+		success = apply_presets(settings, settings->preset, config_text);
+	free(config_text);
+	return (success && apply_environment(settings)
+		&& apply_arguments(settings, argc, argv)
+		&& validate_settings(settings));
+}
+
+/* free_settings:
+ *   Frees the paths and names held by the settings.
+ *
+ *   Parameters:
+ *     - settings: Pointer to the settings structure.
+ */
+void	free_settings(t_settings *settings)
+{
+	free(settings->preset);
+	free(settings->topology);
+	free(settings->timings);
+	free(settings->record);
+	free(settings->replay);
+	free(settings->checkpoint);
+	free(settings->resume);
+	free(settings->calibration);
+	settings->preset = NULL;
+	settings->topology = NULL;
+	settings->timings = NULL;
+	settings->record = NULL;
+	settings->replay = NULL;
+	settings->checkpoint = NULL;
+	settings->resume = NULL;
+	settings->calibration = NULL;
+}
@@ -0,0 +1,126 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   settings_parser.c                                  :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: antestem <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/07/11 16:59:51 by antestem          #+#    #+#             */
+/*   Updated: 2024/07/11 16:59:52 by antestem         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "philosophers.h"
+
+/* section_name:
+ *   Checks whether a config line opens a section, like "[tight]".
+ *
+ *   Parameters:
+ *     - line: The trimmed config line.
+ *
+ *   Returns:
+ *     - The name of the section, or NULL if the line is not a header.
+ */
+static char	*section_name(char *line)
+{
+	size_t	length;
+
+	length = strlen(line);
+	if (length < 2 || line[0] != '[' || line[length - 1] != ']')
+		return (NULL);
+	line[length - 1] = '\0';
+	return (trim_whitespace(line + 1));
+}
+
+/* apply_config_line:
+ *   Applies one "key = value" config line.
+ *
+ *   Parameters:
+ *     - settings: Pointer to the settings structure.
+ *     - line: The trimmed config line.
+ *
+ *   Returns:
+ *     - A boolean indicating whether the line is a valid setting.
+ */
+static bool	apply_config_line(t_settings *settings, char *line)
+{
+	char	*equal_sign;
+
+	equal_sign = strchr(line, '=');
+	if (!equal_sign)
+		return (print_message(ERROR_CONFIG_LINE, line, false));
+	*equal_sign = '\0';
+	return (apply_setting(settings, trim_whitespace(line),
+			trim_whitespace(equal_sign + 1)));
+}
+
+/* is_in_section:
+ *   Checks whether the lines under the current section header should be
+ *   applied: either both are the top level, before any header, or both
+ *   name the same section.
+ *
+ *   Parameters:
+ *     - current: The name of the current section, or NULL.
+ *     - wanted: The name of the section to apply, or NULL.
+ *
+ *   Returns:
+ *     - A boolean indicating whether the current lines apply.
+ */
+static bool	is_in_section(char *current, char *wanted)
+{
+	if (!current || !wanted)
+		return (current == wanted);
+	return (strcmp(current, wanted) == 0);
+}
+
+/* apply_config_text:
+ *   Applies the settings of a config text in a simple INI format: one
+ *   "key = value" per line, '#' or ';' starting a comment line, and
+ *   "[name]" headers opening the section of a preset. Only the lines of
+ *   the requested section are applied, or the lines before the first
+ *   header if section is NULL.
+ *
+ *   Parameters:
+ *     - settings: Pointer to the settings structure.
+ *     - text: The config text.
+ *     - section: The section to apply, or NULL for the top level.
+ *     - found: Set to true if the section exists. May be NULL.
+ *
+ *   Returns:
+ *     - A boolean indicating whether all applied lines are valid.
+ */
+bool	apply_config_text(t_settings *settings, char *text, char *section,
+		bool *found)
+{
+	char	*copy;
+	char	*line;
+	char	*next_line;
+	char	*header;
+	char	*current;
+	bool	success;
+
+	copy = strdup(text);
+	if (!copy)
+		return (print_message(ERROR_MEMORY_ALLOCATION, NULL, false));
+	current = NULL;
+	success = true;
+	line = copy;
+	while (success && line)
+	{
+		next_line = strchr(line, '\n');
+		if (next_line)
+			*next_line++ = '\0';
+		line = trim_whitespace(line);
+		header = section_name(line);
+		if (header)
+			current = header;
+		if (header && found && is_in_section(current, section))
+			*found = true;
+		else if (!header && *line && *line != '#' && *line != ';'
+			&& is_in_section(current, section))
+			success = apply_config_line(settings, line);
+		line = next_line;
+	}
+	free(copy);
+	return (success);
+}
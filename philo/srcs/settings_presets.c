@@ -0,0 +1,111 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   settings_presets.c                                 :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: antestem <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/07/11 16:59:58 by antestem          #+#    #+#             */
+/*   Updated: 2024/07/11 16:59:59 by antestem         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "philosophers.h"
+
+/* builtin_preset:
+ *   Returns the settings of a built-in preset, in config file format.
+ *   The scenario presets set the simulation parameters of a benchmark
+ *   scenario, and the profile presets tune the performance knobs, so
+ *   that they can be combined, for example "tight,low_latency".
+ *
+ *   Parameters:
+ *     - name: The name of the preset.
+ *
+ *   Returns:
+ *     - The preset's config text, or NULL if there is no such preset.
+ */
+static char	*builtin_preset(char *name)
+{
+	if (strcmp(name, "tight") == 0)
+		return ("philosophers = 4\ntime_to_die = 410\n"
+			"time_to_eat = 200\ntime_to_sleep = 200\n");
+	if (strcmp(name, "crowded") == 0)
+		return ("philosophers = 250\ntime_to_die = 800\n"
+			"time_to_eat = 200\ntime_to_sleep = 200\n");
+	if (strcmp(name, "chatty") == 0)
+		return ("philosophers = 200\ntime_to_die = 100\n"
+			"time_to_eat = 10\ntime_to_sleep = 10\nmust_eat = 100\n");
+	if (strcmp(name, "low_latency") == 0)
+		return ("sleep_granularity_us = 50\nreaper_interval_us = 250\n"
+			"pinning = cores\n");
+	if (strcmp(name, "low_cpu") == 0)
+		return ("sleep_granularity_us = 1000\nreaper_interval_us = 2000\n"
+			"acquisition = backoff\n");
+	return (NULL);
+}
+
+/* apply_preset:
+ *   Applies a single preset: first the built-in preset of that name,
+ *   if any, then the config file section of that name, if any.
+ *
+ *   Parameters:
+ *     - settings: Pointer to the settings structure.
+ *     - name: The name of the preset.
+ *     - config_text: The config file text, or NULL if there is none.
+ *
+ *   Returns:
+ *     - A boolean indicating whether the preset exists and is valid.
+ */
+static bool	apply_preset(t_settings *settings, char *name, char *config_text)
+{
+	bool	found;
+
+	found = false;
+	if (builtin_preset(name))
+	{
+		found = true;
+		if (!apply_config_text(settings, builtin_preset(name), NULL, NULL))
+			return (false);
+	}
+	if (config_text
+		&& !apply_config_text(settings, config_text, name, &found))
+		return (false);
+	if (!found)
+		return (print_message(ERROR_UNKNOWN_PRESET, name, false));
+	return (true);
+}
+
+/* apply_presets:
+ *   Applies a comma-separated list of presets, in order.
+ *
+ *   Parameters:
+ *     - settings: Pointer to the settings structure.
+ *     - names: The list of preset names.
+ *     - config_text: The config file text, or NULL if there is none.
+ *
+ *   Returns:
+ *     - A boolean indicating whether all presets exist and are valid.
+ */
+bool	apply_presets(t_settings *settings, char *names, char *config_text)
+{
+	char	*copy;
+	char	*name;
+	char	*next_name;
+	bool	success;
+
+	copy = strdup(names);
+	if (!copy)
+		return (print_message(ERROR_MEMORY_ALLOCATION, NULL, false));
+	success = true;
+	name = copy;
+	while (success && name)
+	{
+		next_name = strchr(name, ',');
+		if (next_name)
+			*next_name++ = '\0';
+		success = apply_preset(settings, trim_whitespace(name), config_text);
+		name = next_name;
+	}
+	free(copy);
+	return (success);
+}
@@ -0,0 +1,146 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   shared_memory.c                                    :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: antestem <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/07/11 17:01:28 by antestem          #+#    #+#             */
+/*   Updated: 2024/07/11 17:01:29 by antestem         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "philosophers.h"
+
+/* create_arena:
+ *   Maps the memory the table is allocated from, when the processes
+ *   setting is above 0 or the footprint setting is "low". With worker
+ *   processes, the mapping is anonymous and shared, so every worker
+ *   forked afterwards sees the same pages. It cannot grow once they are
+ *   forked, so it always spans SHARED_ARENA_SIZE, whatever the table.
+ *   In the "low" footprint mode, it is private, and only replaces the
+ *   many small heap allocations of the table with one mapping, sized
+ *   after the number of philosophers the table has room for.
+ *   Either way, the mapping is made with MAP_NORESERVE: its size is only
+ *   address space, and pages are used as they are allocated.
+ *
+ *   Parameters:
+ *     - settings: Pointer to the loaded settings.
+ *
+ *   Returns:
+ *     - A pointer to the arena, NULL if the table lives on the heap,
+ *       or MAP_FAILED if the mapping failed.
+ */
+t_arena	*create_arena(t_settings *settings)
+{
+	t_arena	*arena;
+	size_t	size;
+	int		sharing;
+
+	if (settings->processes == 0 && settings->footprint != FOOTPRINT_LOW)
+		return (NULL);
+	size = SHARED_ARENA_SIZE;
+	sharing = MAP_SHARED;
+	if (settings->processes == 0)
+	{
+		size = LOW_ARENA_BASE_SIZE + LOW_ARENA_PHILOSOPHER_SIZE
+			* table_capacity(settings);
+		sharing = MAP_PRIVATE;
+	}
+	arena = mmap(NULL, size, PROT_READ | PROT_WRITE,
+			sharing | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	if (arena == MAP_FAILED)
+		return (MAP_FAILED);
+	arena->size = size;
+	arena->used = sizeof(t_arena);
+	return (arena);
+}
+
+/* arena_alloc:
+ *   Allocates zeroed memory from the arena. Arena memory is never
+ *   freed on its own: the whole arena is unmapped at the end.
+ *
+ *   Parameters:
+ *     - arena: Pointer to the arena.
+ *     - size: The number of bytes to allocate.
+ *     - alignment: The alignment of the memory, a power of 2.
+ *
+ *   Returns:
+ *     - A pointer to the memory, or NULL if the arena is full.
+ */
+void	*arena_alloc(t_arena *arena, size_t size, size_t alignment)
+{
+	size_t	start;
+
+	start = (arena->used + alignment - 1) & ~(alignment - 1);
+	if (start + size > arena->size)
+		return (NULL);
+	arena->used = start + size;
+	return ((char *)arena + start);
+}
+
+/* table_alloc:
+ *   Allocates zeroed memory for the state of the table: from the arena
+ *   when the philosophers run in worker processes or the footprint is
+ *   "low", from the heap otherwise.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ *     - size: The number of bytes to allocate, a multiple of alignment.
+ *     - alignment: The alignment of the memory, a power of 2.
+ *
+ *   Returns:
+ *     - A pointer to the memory, or NULL on error.
+ */
+void	*table_alloc(t_dining_table *dining_table, size_t size,
+		size_t alignment)
+{
+	void	*memory;
+
+	if (dining_table->arena)
+		return (arena_alloc(dining_table->arena, size, alignment));
+	memory = aligned_alloc(alignment, size);
+	if (memory)
+		memset(memory, 0, size);
+	return (memory);
+}
+
+/* table_free:
+ *   Frees memory allocated with table_alloc. Memory from the arena is
+ *   left alone.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ *     - memory: The memory to free.
+ */
+void	table_free(t_dining_table *dining_table, void *memory)
+{
+	if (!dining_table->arena)
+		free(memory);
+}
+
+/* table_mutex_init:
+ *   Initializes a mutex the philosophers share. When they run in worker
+ *   processes, the mutex lives in the shared arena and is made usable
+ *   across processes.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ *     - mutex: Pointer to the mutex to initialize.
+ *
+ *   Returns:
+ *     - A boolean indicating whether the mutex was created.
+ */
+bool	table_mutex_init(t_dining_table *dining_table, pthread_mutex_t *mutex)
+{
+	pthread_mutexattr_t	attributes;
+	bool				success;
+
+	if (pthread_mutexattr_init(&attributes) != 0)
+		return (false);
+	if (dining_table->settings.processes > 0)
+		pthread_mutexattr_setpshared(&attributes, PTHREAD_PROCESS_SHARED);
+	success = (pthread_mutex_init(mutex, &attributes) == 0);
+	pthread_mutexattr_destroy(&attributes);
+	return (success);
+}
@@ -0,0 +1,170 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   signal_watcher.c                                   :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: antestem <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/07/11 17:01:32 by antestem          #+#    #+#             */
+/*   Updated: 2024/07/11 17:01:33 by antestem         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "philosophers.h"
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+
+/* print_live_snapshot:
+ *   Prints, on the standard error, how many meals each philosopher had,
+ *   how long ago his last meal started and how many times he had to
+ *   wait for a fork that was in use. Each philosopher is read under his
+ *   last meal lock only, so the simulation keeps running meanwhile. With
+ *   membership churn, the philosophers of the current seating are shown.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ */
+static void	print_live_snapshot(t_dining_table *dining_table)
+{
+	t_seating		*seating;
+	t_philosopher	*philosopher;
+	unsigned long	meals;
+	unsigned int	count;
+	unsigned int	times_ate;
+	time_t			hunger;
+	unsigned int	i;
+
+	fprintf(stderr, "snapshot: at %ld ms\n", get_current_time_in_ms()
+		- dining_table->start_time);
+	fprintf(stderr, "snapshot: philo   meals  hunger_ms  fork_waits\n");
+	meals = 0;
+	seating = enter_seating(dining_table, READER_SIGNALS);
+	count = dining_table->num_philosophers;
+	if (seating != NULL)
+		count = seating->count;
+	i = 0;
+	while (i < count)
+	{
+		philosopher = seated_philosopher(dining_table, seating, i++);
+		pthread_mutex_lock(&philosopher->last_meal_lock);
+		times_ate = philosopher->times_ate;
+		hunger = get_current_time_in_ms() - philosopher->last_meal_time;
+		pthread_mutex_unlock(&philosopher->last_meal_lock);
+		if (hunger < 0)
+			hunger = 0;
+		meals += times_ate;
+		fprintf(stderr, "snapshot: %5u %7u %10ld %11u\n", philosopher->id + 1,
+			times_ate, hunger, atomic_load_explicit(&philosopher->fork_waits,
+				memory_order_relaxed));
+	}
+	leave_seating(dining_table, READER_SIGNALS);
+	fprintf(stderr, "snapshot:   all %7lu\n", meals);
+}
+
+/* signal_watcher_routine:
+ *   The signal watcher thread's routine. Waits for the signals blocked
+ *   by start_signal_watcher, or for stop_signal_watcher to wake it up.
+ *   SIGUSR1 prints a snapshot of the table. SIGINT and SIGTERM stop the
+ *   simulation, which then ends like any other run: the threads are
+ *   joined, the output is flushed and the reports are printed.
+ *
+ *   Parameters:
+ *     - data: Pointer to the dining_table structure.
+ *
+ *   Returns:
+ *     - A NULL pointer once stop_signal_watcher was called.
+ */
+static void	*signal_watcher_routine(void *data)
+{
+	t_dining_table			*dining_table;
+	struct pollfd			fds[2];
+	struct signalfd_siginfo	info;
+
+	dining_table = (t_dining_table *)data;
+	fds[0].fd = dining_table->signals.signal_fd;
+	fds[0].events = POLLIN;
+	fds[1].fd = dining_table->signals.wakeup_fd;
+	fds[1].events = POLLIN;
+	while (poll(fds, 2, -1) >= 0 || errno == EINTR)
+	{
+		if (fds[1].revents & POLLIN)
+			break ;
+		if (!(fds[0].revents & POLLIN) || read(fds[0].fd, &info,
+				sizeof(info)) != sizeof(info))
+			continue ;
+		if (info.ssi_signo == SIGUSR1)
+			print_live_snapshot(dining_table);
+		else
+		{
+			if (!is_simulation_stopped(dining_table))
+				atomic_store(&dining_table->signals.stop_signal,
+					info.ssi_signo);
+			set_simulation_stop_flag(dining_table, true);
+		}
+	}
+	return (NULL);
+}
+
+/* start_signal_watcher:
+ *   Blocks SIGINT, SIGTERM and SIGUSR1 in the calling thread, before it
+ *   creates the other threads and the worker processes so that they all
+ *   inherit the mask, then starts a thread that receives these signals
+ *   through a signalfd.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ *
+ *   Returns:
+ *     - A boolean indicating whether the watcher was started.
+ */
+bool	start_signal_watcher(t_dining_table *dining_table)
+{
+	t_signal_watcher	*signals;
+	sigset_t			mask;
+
+	signals = &dining_table->signals;
+	sigemptyset(&mask);
+	sigaddset(&mask, SIGINT);
+	sigaddset(&mask, SIGTERM);
+	sigaddset(&mask, SIGUSR1);
+	if (pthread_sigmask(SIG_BLOCK, &mask, NULL) != 0)
+		return (false);
+	signals->signal_fd = signalfd(-1, &mask, SFD_CLOEXEC);
+	signals->wakeup_fd = eventfd(0, EFD_CLOEXEC);
+	if (signals->signal_fd >= 0 && signals->wakeup_fd >= 0
+		&& pthread_create(&signals->thread, NULL, &signal_watcher_routine,
+			dining_table) == 0)
+	{
+		signals->started = true;
+		return (true);
+	}
+	if (signals->signal_fd >= 0)
+		close(signals->signal_fd);
+	if (signals->wakeup_fd >= 0)
+		close(signals->wakeup_fd);
+	return (false);
+}
+
+/* stop_signal_watcher:
+ *   Wakes the signal watcher thread up and joins it, if it was started.
+ *   The signals stay blocked, so that one received from now on does not
+ *   interrupt the teardown.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ */
+void	stop_signal_watcher(t_dining_table *dining_table)
+{
+	uint64_t	one;
+
+	if (!dining_table->signals.started)
+		return ;
+	one = 1;
+	if (write(dining_table->signals.wakeup_fd, &one, sizeof(one))
+		== sizeof(one))
+		pthread_join(dining_table->signals.thread, NULL);
+	close(dining_table->signals.signal_fd);
+	close(dining_table->signals.wakeup_fd);
+	dining_table->signals.started = false;
+}
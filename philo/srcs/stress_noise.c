@@ -0,0 +1,45 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   stress_noise.c                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: antestem <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/07/11 17:01:06 by antestem          #+#    #+#             */
+/*   Updated: 2024/07/11 17:01:07 by antestem         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "philosophers.h"
+
+#if STRESS_NOISE
+
+/* noise_point:
+ *   Only built with STRESS=1. Marks a lock or sleep point where the
+ *   scheduling can be disturbed: most of the time nothing happens, but
+ *   the thread may also yield the CPU or sleep for up to noise_max_us.
+ *   Each thread draws from its own xorshift state, seeded from the
+ *   noise_seed setting, so a seed always gives each thread the same
+ *   sequence of delays. A noise_max_us of 0 disables the noise.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ *     - seed: The calling thread's noise state.
+ */
+void	noise_point(t_dining_table *dining_table, unsigned int *seed)
+{
+	unsigned int	draw;
+
+	if (dining_table->settings.noise_max_us <= 0)
+		return ;
+	*seed ^= *seed << 13;
+	*seed ^= *seed >> 17;
+	*seed ^= *seed << 5;
+	draw = *seed;
+	if (draw % 8 == 6)
+		sched_yield();
+	else if (draw % 8 == 7)
+		usleep((draw >> 3) % (dining_table->settings.noise_max_us + 1));
+}
+
+#endif
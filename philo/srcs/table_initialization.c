@@ -13,28 +13,32 @@
 #include "philosophers.h"
 
 /* init_fork_mutexes:
- *   Allocates memory and initializes fork mutexes.
- *   Returns a pointer to the fork mutex array, or NULL if an error occurred.
+ *   Allocates memory and initializes fork locks. The kind of lock is
+ *   chosen at build time with the FORK_LOCK Makefile variable.
+ *   Returns a pointer to the fork lock array, or NULL if an error occurred.
  *
  *   Parameters:
  *     - dining_table: Pointer to the dining_table structure.
  *
  *   Returns:
- *     - A pointer to the allocated fork mutex array, or NULL on error.
+ *     - A pointer to the allocated fork lock array, or NULL on error.
  */
-static pthread_mutex_t	*init_fork_mutexes(t_dining_table *dining_table)
+static t_fork_lock	*init_fork_mutexes(t_dining_table *dining_table)
 {
-	pthread_mutex_t	*forks;
+	t_fork_lock		*forks;
 	unsigned int	i;
 
-	forks = malloc(sizeof(pthread_mutex_t) * dining_table->num_philosophers);
+	forks = table_alloc(dining_table,
+			sizeof(t_fork_lock) * dining_table->num_forks,
+			_Alignof(t_fork_lock));
 	if (!forks)
 		return (print_error_and_return_null(ERROR_MEMORY_ALLOCATION, NULL,
 				dining_table));
 	i = 0;
-	while (i < dining_table->num_philosophers)
+	while (i < dining_table->num_forks)
 	{
-		if (pthread_mutex_init(&forks[i], NULL) != 0)
+		if (!fork_lock_init(&forks[i],
+				dining_table->settings.processes > 0))
 			return (print_error_and_return_null(ERROR_MUTEX_CREATION, NULL,
 					dining_table));
 		i++;
@@ -43,7 +47,10 @@ static pthread_mutex_t	*init_fork_mutexes(t_dining_table *dining_table)
 }
 
 /* assign_forks_to_philosopher:
- *   Assigns two fork ids to each philosopher. Even-numbered philosophers
+ *   Assigns the default ring of forks: two fork ids to each philosopher.
+ *   A topology loaded with load_topology replaces these resource sets
+ *   afterwards. Returns false if the allocation failed.
+ *   Even-numbered philosophers
  *   get their fork order switched. This is because the order in which
  *   philosophers take their forks matters.
  *
@@ -71,21 +78,31 @@ static pthread_mutex_t	*init_fork_mutexes(t_dining_table *dining_table)
  *     take fork 0 and eat. When he is done,
  *     philosopher #2 can finally get fork 1 and eat.
  */
-static void	assign_forks_to_philosopher(t_philosopher *philosopher)
+static bool	assign_forks_to_philosopher(t_philosopher *philosopher)
 {
-	philosopher->fork[0] = philosopher->id;
-	philosopher->fork[1] = (philosopher->id + 1)
+	philosopher->forks = table_alloc(philosopher->dining_table,
+			sizeof(unsigned int) * 2, _Alignof(unsigned int));
+	philosopher->fork_nodes = table_alloc(philosopher->dining_table,
+			sizeof(t_fork_node) * 2, _Alignof(t_fork_node));
+	if (!philosopher->forks || !philosopher->fork_nodes)
+		return (false);
+	philosopher->num_forks = 2;
+	philosopher->forks[0] = philosopher->id;
+	philosopher->forks[1] = (philosopher->id + 1)
 		% philosopher->dining_table->num_philosophers;
 	if (philosopher->id % 2)
 	{
-		philosopher->fork[0] = (philosopher->id + 1)
+		philosopher->forks[0] = (philosopher->id + 1)
 			% philosopher->dining_table->num_philosophers;
-		philosopher->fork[1] = philosopher->id;
+		philosopher->forks[1] = philosopher->id;
 	}
+	return (true);
 }
 
 /* init_philosophers:
- *   Allocates memory for each philosopher and initializes their values.
+ *   Allocates memory for each philosopher and initializes their values,
+ *   including those of the free entries kept for the philosophers who
+ *   join with membership churn.
  *   Returns a pointer to the array of philosophers or NULL if
  *   initialization failed.
  *
@@ -100,25 +117,36 @@ static t_philosopher	**init_philosophers(t_dining_table *dining_table)
 	t_philosopher	**philosophers;
 	unsigned int	i;
 
-	philosophers = malloc(sizeof(t_philosopher)
-			* dining_table->num_philosophers);
+	philosophers = table_alloc(dining_table,
+			sizeof(t_philosopher *) * dining_table->capacity,
+			_Alignof(t_philosopher *));
 	if (!philosophers)
 		return (print_error_and_return_null(ERROR_MEMORY_ALLOCATION, NULL,
 				dining_table));
+	dining_table->philosophers = philosophers;
 	i = 0;
-	while (i < dining_table->num_philosophers)
+	while (i < dining_table->capacity)
 	{
-		philosophers[i] = malloc(sizeof(t_philosopher));
+		philosophers[i] = table_alloc(dining_table, sizeof(t_philosopher),
+				_Alignof(t_philosopher));
 		if (!philosophers[i])
 			return (print_error_and_return_null(ERROR_MEMORY_ALLOCATION, NULL,
 					dining_table));
-		if (pthread_mutex_init(&philosophers[i]->last_meal_lock, NULL) != 0)
+		if (!table_mutex_init(dining_table, &philosophers[i]->last_meal_lock))
 			return (print_error_and_return_null(ERROR_MUTEX_CREATION, NULL,
 					dining_table));
 		philosophers[i]->dining_table = dining_table;
 		philosophers[i]->id = i;
+		philosophers[i]->index = i;
 		philosophers[i]->times_ate = 0;
-		assign_forks_to_philosopher(philosophers[i]);
+		philosophers[i]->backoff_seed = i + 1;
+		philosophers[i]->noise_seed = (dining_table->settings.noise_seed
+				* NOISE_SEED_MIX) ^ (i + 1);
+		init_philosopher_timings(philosophers[i]);
+		record_phase(philosophers[i], PHILO_THINKING, 0);
+		if (!assign_forks_to_philosopher(philosophers[i]))
+			return (print_error_and_return_null(ERROR_MEMORY_ALLOCATION, NULL,
+					dining_table));
 		i++;
 	}
 	return (philosophers);
@@ -141,47 +169,77 @@ static bool	init_global_mutexes(t_dining_table *dining_table)
 	dining_table->fork_locks = init_fork_mutexes(dining_table);
 	if (!dining_table->fork_locks)
 		return (false);
-	if (pthread_mutex_init(&dining_table->simulation_stop_lock, NULL) != 0)
+	if (!table_mutex_init(dining_table, &dining_table->simulation_stop_lock))
 		return (print_error_and_exit(ERROR_MUTEX_CREATION, NULL, dining_table));
-	if (pthread_mutex_init(&dining_table->write_lock, NULL) != 0)
+	if (!table_mutex_init(dining_table, &dining_table->write_lock))
 		return (print_error_and_exit(ERROR_MUTEX_CREATION, NULL, dining_table));
 	return (true);
 }
 
 /* init_dining_table:
  *   Initializes the "dining table", the data structure containing
- *   all of the program's parameters.
+ *   all of the program's parameters, from the loaded settings, then
+ *   applies the settings that change the layout of the table, seats the
+ *   philosophers for the membership churn and plans the ideal schedule
+ *   of the resulting table. The table takes ownership of the settings'
+ *   strings.
  *   Returns a pointer to the allocated table structure, or NULL if
  *   an error occurred during initialization.
  *
  *   Parameters:
- *     - argc: The number of command-line arguments.
- *     - argv: The array of command-line arguments.
- *     - i: The index to start parsing arguments from.
+ *     - settings: Pointer to the settings loaded by load_settings.
  *
  *   Returns:
  *     - A pointer to the allocated dining_table structure, or NULL on error.
  */
-t_dining_table	*init_dining_table(int argc, char **argv, int i)
+t_dining_table	*init_dining_table(t_settings *settings)
 {
 	t_dining_table	*dining_table;
+	t_arena			*arena;
 
-	dining_table = malloc(sizeof(t_dining_table));
+	arena = create_arena(settings);
+	dining_table = NULL;
+	if (arena == NULL)
+		dining_table = calloc(1, sizeof(t_dining_table));
+	else if (arena != MAP_FAILED)
+		dining_table = arena_alloc(arena, sizeof(t_dining_table),
+				_Alignof(t_dining_table));
 	if (!dining_table)
+	{
+		if (arena != NULL && arena != MAP_FAILED)
+			munmap(arena, arena->size);
+		free_settings(settings);
 		return (print_error_and_return_null(ERROR_MEMORY_ALLOCATION, NULL,
 				NULL));
-	dining_table->num_philosophers = parse_integer(argv[i++]);
-	dining_table->time_to_die = parse_integer(argv[i++]);
-	dining_table->time_to_eat = parse_integer(argv[i++]);
-	dining_table->time_to_sleep = parse_integer(argv[i++]);
-	dining_table->must_eat_count = -1;
-	if (argc - 1 == 5)
-		dining_table->must_eat_count = parse_integer(argv[i]);
+	}
+	dining_table->arena = arena;
+	dining_table->settings = *settings;
+	dining_table->checkpoint.fd = -1;
+	dining_table->num_philosophers = settings->num_philosophers;
+	dining_table->time_to_die = settings->time_to_die;
+	dining_table->time_to_eat = settings->time_to_eat;
+	dining_table->time_to_sleep = settings->time_to_sleep;
+	dining_table->must_eat_count = settings->must_eat_count;
+	dining_table->capacity = table_capacity(settings);
+	dining_table->num_forks = dining_table->capacity;
+	dining_table->num_classes = 1;
+	dining_table->noise_seed = (settings->noise_seed * NOISE_SEED_MIX)
+		^ (dining_table->num_philosophers + 1);
 	dining_table->philosophers = init_philosophers(dining_table);
 	if (!dining_table->philosophers)
 		return (NULL);
+	if (!load_table_options(dining_table))
+		return (NULL);
+	if (!init_membership(dining_table))
+		return (NULL);
+	plan_schedule(dining_table);
+	if (settings->writer == WRITER_MERGED && !init_output(dining_table))
+		return (NULL);
 	if (!init_global_mutexes(dining_table))
 		return (NULL);
+	if (!init_thread_stacks(dining_table))
+		return (print_error_and_return_null(ERROR_MEMORY_ALLOCATION, NULL,
+				dining_table));
 	dining_table->simulation_stopped = false;
 	return (dining_table);
 }
@@ -0,0 +1,149 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   table_options.c                                    :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: antestem <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/07/11 16:59:27 by antestem          #+#    #+#             */
+/*   Updated: 2024/07/11 16:59:28 by antestem         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "philosophers.h"
+
+#ifdef FIXED_DESCRIPTION
+
+/* is_fixed_build_table:
+ *   In a fixed build, checks that the table has the parameters the
+ *   build was specialized for, the same for every philosopher, and a
+ *   number of philosophers that does not change.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ *
+ *   Returns:
+ *     - A boolean indicating whether this build can run the table.
+ */
+static bool	is_fixed_build_table(t_dining_table *dining_table)
+{
+	return (dining_table->num_philosophers == FIXED_PHILOSOPHERS
+		&& dining_table->time_to_die == FIXED_TIME_TO_DIE
+		&& dining_table->time_to_eat == FIXED_TIME_TO_EAT
+		&& dining_table->time_to_sleep == FIXED_TIME_TO_SLEEP
+		&& dining_table->must_eat_count == FIXED_MUST_EAT
+		&& !dining_table->settings.timings
+		&& dining_table->settings.churn_interval_us == 0);
+}
+#endif
+
+/* supports_membership:
+ *   Checks that the table can let philosophers join and leave while it
+ *   runs: the seating only describes a ring of at least two
+ *   philosophers, in threads of this process, whose output the locked
+ *   writer prints as it comes. Traces, the oracle and the static
+ *   schedule all need a number of philosophers that does not change.
+ *
+ *   Parameters:
+ *     - settings: Pointer to the table's settings.
+ *
+ *   Returns:
+ *     - A boolean indicating whether membership churn is possible.
+ */
+static bool	supports_membership(t_settings *settings)
+{
+	return (settings->num_philosophers >= 2 && !settings->topology
+		&& settings->processes == 0 && settings->writer == WRITER_LOCKED
+		&& settings->schedule == SCHEDULE_DYNAMIC
+		&& settings->oracle == ORACLE_OFF
+		&& !settings->record && !settings->replay);
+}
+
+/* supports_checkpoints:
+ *   Checks that the table's checkpoints can be taken and resumed: they
+ *   record a fixed number of philosophers, and a resumed run has to
+ *   pick up each philosopher where he stood, which neither the static
+ *   schedule nor a replayed trace allow.
+ *
+ *   Parameters:
+ *     - settings: Pointer to the table's settings.
+ *
+ *   Returns:
+ *     - A boolean indicating whether the checkpoint settings are valid.
+ */
+static bool	supports_checkpoints(t_settings *settings)
+{
+	if (settings->churn_interval_us > 0)
+		return (false);
+	return (!settings->resume || (settings->schedule == SCHEDULE_DYNAMIC
+			&& !settings->replay));
+}
+
+/* load_table_options:
+ *   Applies the settings that change how the table is laid out or how
+ *   the run is scheduled:
+ *     - topology: an edge list file of the forks each philosopher needs,
+ *       instead of the default ring. The static schedule can only be
+ *       followed on the default ring.
+ *     - timings: a file of timing classes, giving some philosophers
+ *       their own time_to_die, time_to_eat and time_to_sleep. The static
+ *       schedule needs the same timings for everyone.
+ *     - record or replay: a trace file to record the scheduling of the
+ *       run into, or to replay it from.
+ *     - churn_interval_us: how often a philosopher joins or leaves the
+ *       table while it runs, which only some tables support.
+ *     - output: the "compressed" output is only made by the output
+ *       thread of the merged writer.
+ *     - resume and checkpoint: a checkpoint file to resume the run from,
+ *       and one to take checkpoints into as it runs, which can be the
+ *       same file.
+ *   In a fixed build, also refuses any other parameters than the ones
+ *   it was built for. Frees the dining table if an option is invalid.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ *
+ *   Returns:
+ *     - A boolean indicating whether all options are valid.
+ */
+bool	load_table_options(t_dining_table *dining_table)
+{
+	t_settings	*settings;
+
+	settings = &dining_table->settings;
+#ifdef FIXED_DESCRIPTION
+	if (!is_fixed_build_table(dining_table))
+		return (print_error_and_exit(ERROR_FIXED_BUILD, FIXED_DESCRIPTION,
+				dining_table));
+#endif
+	if (settings->topology
+		&& !load_topology(dining_table, settings->topology))
+		return (false);
+	if (settings->timings
+		&& !load_timings(dining_table, settings->timings))
+		return (false);
+	if ((settings->topology || settings->timings)
+		&& settings->schedule == SCHEDULE_STATIC)
+		return (print_error_and_exit(ERROR_STATIC_SCHEDULE, NULL,
+				dining_table));
+	if (settings->output_mode == OUTPUT_COMPRESSED
+		&& settings->writer != WRITER_MERGED)
+		return (print_error_and_exit(ERROR_COMPRESSED_OUTPUT, NULL,
+				dining_table));
+	if (settings->churn_interval_us > 0 && !supports_membership(settings))
+		return (print_error_and_exit(ERROR_MEMBERSHIP, NULL, dining_table));
+	if ((settings->checkpoint || settings->resume)
+		&& !supports_checkpoints(settings))
+		return (print_error_and_exit(ERROR_CHECKPOINT_MODE, NULL,
+				dining_table));
+	if (settings->resume && !load_checkpoint(dining_table, settings->resume))
+		return (false);
+	if (settings->checkpoint
+		&& !open_checkpoint(dining_table, settings->checkpoint))
+		return (false);
+	if (settings->record)
+		return (open_trace(dining_table, TRACE_RECORD, settings->record));
+	if (settings->replay)
+		return (open_trace(dining_table, TRACE_REPLAY, settings->replay));
+	return (true);
+}
@@ -0,0 +1,125 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   thread_stacks.c                                    :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: antestem <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/07/11 17:01:34 by antestem          #+#    #+#             */
+/*   Updated: 2024/07/11 17:01:35 by antestem         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "philosophers.h"
+
+/* stack_size:
+ *   Returns the size of each philosopher's stack in the "low" footprint
+ *   mode: the stack_size_kb setting, at least PTHREAD_STACK_MIN, rounded
+ *   up to whole pages.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ *     - page_size: The size of a memory page.
+ *
+ *   Returns:
+ *     - The size of a stack, in bytes.
+ */
+static size_t	stack_size(t_dining_table *dining_table, size_t page_size)
+{
+	size_t	size;
+
+	size = (size_t)dining_table->settings.stack_size_kb * 1024;
+	if (size < (size_t)PTHREAD_STACK_MIN)
+		size = PTHREAD_STACK_MIN;
+	return ((size + page_size - 1) & ~(page_size - 1));
+}
+
+/* init_thread_stacks:
+ *   In the "low" footprint mode, maps one region holding the stacks of
+ *   all the philosophers' threads, instead of letting each thread map
+ *   a default stack of several megabytes, with room for the philosophers
+ *   who join with membership churn. Each stack is preceded by a
+ *   guard page, which is made inaccessible so that an overflow faults
+ *   instead of running into the neighbor's stack.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ *
+ *   Returns:
+ *     - A boolean indicating whether the stacks, if needed, were mapped.
+ */
+bool	init_thread_stacks(t_dining_table *dining_table)
+{
+	t_thread_stacks	*stacks;
+	unsigned int	i;
+
+	stacks = &dining_table->stacks;
+	if (dining_table->settings.footprint != FOOTPRINT_LOW)
+		return (true);
+	stacks->guard_size = sysconf(_SC_PAGESIZE);
+	stacks->slot_size = stacks->guard_size
+		+ stack_size(dining_table, stacks->guard_size);
+	stacks->region_size = stacks->slot_size * dining_table->capacity;
+	stacks->region = mmap(NULL, stacks->region_size, PROT_READ | PROT_WRITE,
+			MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_STACK, -1, 0);
+	if (stacks->region == MAP_FAILED)
+	{
+		stacks->region = NULL;
+		return (false);
+	}
+	i = 0;
+	while (i < dining_table->capacity)
+	{
+		if (mprotect(stacks->region + stacks->slot_size * i++,
+				stacks->guard_size, PROT_NONE) != 0)
+			return (false);
+	}
+	return (true);
+}
+
+/* create_philosopher_thread:
+ *   Creates the thread of one philosopher: with the default attributes,
+ *   or on his own slot of the stack region in the "low" footprint mode.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ *     - i: The index of the philosopher.
+ *
+ *   Returns:
+ *     - A boolean indicating whether the thread was created.
+ */
+bool	create_philosopher_thread(t_dining_table *dining_table, unsigned int i)
+{
+	t_thread_stacks	*stacks;
+	pthread_attr_t	attributes;
+	bool			success;
+
+	stacks = &dining_table->stacks;
+	if (!stacks->region)
+		return (pthread_create(&dining_table->philosophers[i]->thread, NULL,
+				&philosopher_routine, dining_table->philosophers[i]) == 0);
+	if (pthread_attr_init(&attributes) != 0)
+		return (false);
+	success = (pthread_attr_setstack(&attributes, stacks->region
+				+ stacks->slot_size * i + stacks->guard_size,
+				stacks->slot_size - stacks->guard_size) == 0
+			&& pthread_create(&dining_table->philosophers[i]->thread,
+				&attributes, &philosopher_routine,
+				dining_table->philosophers[i]) == 0);
+	pthread_attr_destroy(&attributes);
+	return (success);
+}
+
+/* free_thread_stacks:
+ *   Unmaps the stack region of the "low" footprint mode, once every
+ *   philosopher's thread was joined.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ */
+void	free_thread_stacks(t_dining_table *dining_table)
+{
+	if (dining_table->stacks.region)
+		munmap(dining_table->stacks.region, dining_table->stacks.region_size);
+	dining_table->stacks.region = NULL;
+}
@@ -27,26 +27,124 @@ time_t	get_current_time_in_ms(void)
 	return ((tv.tv_sec * 1000) + (tv.tv_usec / 1000));
 }
 
+/* get_current_time_in_ns:
+ *   Gets the current time in nanoseconds since the Epoch, from the same
+ *   clock as get_current_time_in_ms. Buffered output events are ordered
+ *   by this time: a fork handed from one philosopher to another always
+ *   gets a later time, which a millisecond timestamp cannot guarantee.
+ *
+ *   Returns:
+ *     - The current time in nanoseconds.
+ */
+uint64_t	get_current_time_in_ns(void)
+{
+	struct timespec	ts;
+
+	clock_gettime(CLOCK_REALTIME, &ts);
+	return ((uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec);
+}
+
 /* philosopher_sleep:
  *   Pauses the philosopher thread for a certain amount of time in milliseconds.
  *   Periodically checks to see if the simulation has ended during the sleep
- *   time and cuts the sleep short if it has.
+ *   time and cuts the sleep short if it has. The last sleep_spin_us before
+ *   the wakeup time are spun rather than slept, so that a late wakeup of
+ *   the host does not make the philosopher late (see calibrate). The
+ *   wakeup is a trace event, so it can be recorded and replayed. With the
+ *   "states" profile, the checks count as overhead.
  *
  *   Parameters:
- *     - dining_table: Pointer to the dining_table structure.
+ *     - philosopher: Pointer to the sleeping philosopher.
  *     - sleep_time: The time to sleep in milliseconds.
  */
-void	philosopher_sleep(t_dining_table *dining_table, time_t sleep_time)
+void	philosopher_sleep(t_philosopher *philosopher, time_t sleep_time)
 {
-	time_t	wake_up_time;
+	uint64_t	wake_up_time;
+	uint64_t	spin;
+	uint64_t	now;
+	uint64_t	pause;
+	uint64_t	overhead;
+	bool		stopped;
 
-	wake_up_time = get_current_time_in_ms() + sleep_time;
-	while (get_current_time_in_ms() < wake_up_time)
+	wake_up_time = (uint64_t)(get_current_time_in_ms() + sleep_time)
+		* 1000000;
+	spin = (uint64_t)philosopher->dining_table->settings.sleep_spin_us * 1000;
+	now = get_current_time_in_ns();
+	stopped = false;
+	while (!stopped && now + spin < wake_up_time)
 	{
-		if (is_simulation_stopped(dining_table))
+		overhead = profile_overhead_start(philosopher);
+		stopped = is_simulation_stopped(philosopher->dining_table);
+		profile_overhead_end(philosopher, overhead);
+		if (stopped)
 			break ;
-		usleep(100);
+		NOISE_POINT(philosopher->dining_table, &philosopher->noise_seed);
+		pause = philosopher->dining_table->settings.sleep_granularity_us;
+		if (spin > 0 && (wake_up_time - now - spin) / 1000 < pause)
+			pause = (wake_up_time - now - spin) / 1000;
+		usleep(pause);
+		now = get_current_time_in_ns();
+	}
+	while (!stopped && now < wake_up_time)
+	{
+		CPU_RELAX();
+		now = get_current_time_in_ns();
+	}
+	trace_before(philosopher, TRACE_WAKEUP, 0);
+	trace_after(philosopher, TRACE_WAKEUP, 0);
+}
+
+/* philosopher_sleep_until:
+ *   Pauses the philosopher thread until an absolute time, so that
+ *   lateness in one step of a schedule does not push back the next
+ *   ones. Sleeps on the absolute clock for at most sleep_granularity_us
+ *   at a time, to check whether the simulation has ended in between.
+ *   Like in philosopher_sleep, the last sleep_spin_us are spun and the
+ *   wakeup is a trace event.
+ *
+ *   Parameters:
+ *     - philosopher: Pointer to the sleeping philosopher.
+ *     - wake_up_time: The time to wake up at, in nanoseconds since the
+ *       Epoch (see get_current_time_in_ns).
+ */
+void	philosopher_sleep_until(t_philosopher *philosopher,
+		uint64_t wake_up_time)
+{
+	struct timespec	ts;
+	uint64_t		spin;
+	uint64_t		next;
+	uint64_t		overhead;
+	bool			stopped;
+
+	spin = (uint64_t)philosopher->dining_table->settings.sleep_spin_us * 1000;
+	next = get_current_time_in_ns();
+	stopped = false;
+	while (!stopped && next + spin < wake_up_time)
+	{
+		overhead = profile_overhead_start(philosopher);
+		stopped = is_simulation_stopped(philosopher->dining_table);
+		profile_overhead_end(philosopher, overhead);
+		if (stopped)
+			break ;
+		NOISE_POINT(philosopher->dining_table, &philosopher->noise_seed);
+		next += (uint64_t)philosopher->dining_table->settings.\
+		sleep_granularity_us * 1000;
+		if (next > wake_up_time - spin)
+			next = wake_up_time - spin;
+		ts.tv_sec = next / 1000000000;
+		ts.tv_nsec = next % 1000000000;
+		while (clock_nanosleep(CLOCK_REALTIME, TIMER_ABSTIME, &ts, NULL)
+			== EINTR)
+			continue ;
+		next = get_current_time_in_ns();
+	}
+	while (!stopped && next < wake_up_time)
+	{
+		CPU_RELAX();
+		next = get_current_time_in_ns();
 	}
+	trace_before(philosopher, TRACE_WAKEUP, 0);
+	trace_after(philosopher, TRACE_WAKEUP, 0);
 }
 
 /* delay_simulation_start:
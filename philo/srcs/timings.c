@@ -0,0 +1,73 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   timings.c                                          :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: antestem <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/07/11 17:01:38 by antestem          #+#    #+#             */
+/*   Updated: 2024/07/11 17:01:39 by antestem         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "philosophers.h"
+
+/* init_philosopher_timings:
+ *   Gives a philosopher the table's timings, as a member of the default
+ *   timing class 0, and seeds his jitter from the jitter_seed setting.
+ *
+ *   Parameters:
+ *     - philosopher: Pointer to the philosopher structure.
+ */
+void	init_philosopher_timings(t_philosopher *philosopher)
+{
+	t_dining_table	*dining_table;
+
+	dining_table = philosopher->dining_table;
+	philosopher->timing_class = 0;
+	philosopher->time_to_die = dining_table->time_to_die;
+	philosopher->time_to_eat = dining_table->time_to_eat;
+	philosopher->time_to_sleep = dining_table->time_to_sleep;
+	philosopher->jitter_ms = 0;
+	philosopher->jitter_seed = (dining_table->settings.jitter_seed
+			* NOISE_SEED_MIX) ^ (philosopher->id + 1);
+}
+
+/* jittered_duration:
+ *   Adds the random jitter of the philosopher's timing class to the
+ *   duration of a meal or a nap: up to jitter_ms milliseconds, drawn
+ *   from the philosopher's own xorshift state so that a run can be
+ *   repeated with the same jitter_seed.
+ *
+ *   Parameters:
+ *     - philosopher: Pointer to the philosopher structure.
+ *     - duration: The duration without jitter, in milliseconds.
+ *
+ *   Returns:
+ *     - The duration with jitter, in milliseconds.
+ */
+time_t	jittered_duration(t_philosopher *philosopher, time_t duration)
+{
+	if (philosopher->jitter_ms == 0)
+		return (duration);
+	philosopher->jitter_seed ^= philosopher->jitter_seed << 13;
+	philosopher->jitter_seed ^= philosopher->jitter_seed >> 17;
+	philosopher->jitter_seed ^= philosopher->jitter_seed << 5;
+	return (duration + philosopher->jitter_seed % (philosopher->jitter_ms + 1));
+}
+
+/* record_meal_start:
+ *   Records the start of a meal, and the longest the philosopher has
+ *   gone without eating so far, from the start of the simulation or of
+ *   his previous meal. The caller holds the last meal lock.
+ *
+ *   Parameters:
+ *     - philosopher: Pointer to the philosopher structure.
+ *     - now: The time the meal starts, in milliseconds.
+ */
+void	record_meal_start(t_philosopher *philosopher, time_t now)
+{
+	if (now - philosopher->last_meal_time > philosopher->longest_hunger)
+		philosopher->longest_hunger = now - philosopher->last_meal_time;
+	philosopher->last_meal_time = now;
+}
@@ -0,0 +1,129 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   timings_loader.c                                   :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: antestem <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/07/11 17:01:40 by antestem          #+#    #+#             */
+/*   Updated: 2024/07/11 17:01:41 by antestem         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "philosophers.h"
+
+/* count_classes:
+ *   Counts the numbers in the timings file to find out how many timing
+ *   classes it describes.
+ *
+ *   Parameters:
+ *     - buffer: The contents of the timings file.
+ *     - num_classes: Where to store the number of classes.
+ *
+ *   Returns:
+ *     - A boolean indicating whether the file is well-formed.
+ */
+static bool	count_classes(char *buffer, unsigned int *num_classes)
+{
+	unsigned int	count;
+	unsigned int	value;
+	int				status;
+
+	count = 0;
+	status = next_number(&buffer, &value);
+	while (status == 1)
+	{
+		count++;
+		status = next_number(&buffer, &value);
+	}
+	if (status == -1)
+		return (print_message(ERROR_TIMINGS_FORMAT,
+				"expected unsigned integers only", false));
+	if (count == 0 || count % TIMING_CLASS_FIELDS)
+		return (print_message(ERROR_TIMINGS_FORMAT, "expected \"<first> "
+				"<last> <time_to_die> <time_to_eat> <time_to_sleep> "
+				"<jitter>\" lines", false));
+	*num_classes = count / TIMING_CLASS_FIELDS;
+	return (true);
+}
+
+/* apply_class:
+ *   Gives the timings of one class to the philosophers it lists.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ *     - class: The number of the class, from 1.
+ *     - fields: The class's fields, in the order of the file.
+ *
+ *   Returns:
+ *     - A boolean indicating whether the philosophers are within range.
+ */
+static bool	apply_class(t_dining_table *dining_table, unsigned int class,
+		unsigned int *fields)
+{
+	t_philosopher	*philosopher;
+	unsigned int	i;
+
+	if (fields[0] < 1 || fields[0] > fields[1]
+		|| fields[1] > dining_table->num_philosophers)
+		return (print_message(ERROR_TIMINGS_FORMAT,
+				"philosopher range out of bounds", false));
+	i = fields[0] - 1;
+	while (i < fields[1])
+	{
+		philosopher = dining_table->philosophers[i++];
+		philosopher->timing_class = class;
+		philosopher->time_to_die = fields[2];
+		philosopher->time_to_eat = fields[3];
+		philosopher->time_to_sleep = fields[4];
+		philosopher->jitter_ms = fields[5];
+	}
+	return (true);
+}
+
+/* load_timings:
+ *   Reads a file of timing classes, giving some philosophers their own
+ *   timings instead of the ones of the command line. Each class is a
+ *   "<first> <last> <time_to_die> <time_to_eat> <time_to_sleep>
+ *   <jitter>" line: philosophers first to last, numbered from 1 as in
+ *   the simulation output, get these timings, and each of their meals
+ *   and naps lasts up to jitter milliseconds longer. '#' starts a
+ *   comment. Classes are numbered from 1 in the order of the file, a
+ *   later class overriding an earlier one, and philosophers listed in
+ *   none stay in class 0. Frees the dining table if the file is invalid.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ *     - path: The path of the timings file.
+ *
+ *   Returns:
+ *     - A boolean indicating whether the timings were applied.
+ */
+bool	load_timings(t_dining_table *dining_table, char *path)
+{
+	char			*buffer;
+	char			*cursor;
+	unsigned int	fields[TIMING_CLASS_FIELDS];
+	unsigned int	field;
+	unsigned int	class;
+	bool			success;
+
+	buffer = read_text_file(path);
+	if (!buffer)
+		return (print_error_and_exit(ERROR_TIMINGS_FILE, path, dining_table));
+	success = count_classes(buffer, &dining_table->num_classes);
+	dining_table->num_classes++;
+	cursor = buffer;
+	class = 0;
+	while (success && next_number(&cursor, &fields[0]) == 1)
+	{
+		field = 1;
+		while (field < TIMING_CLASS_FIELDS)
+			next_number(&cursor, &fields[field++]);
+		success = apply_class(dining_table, ++class, fields);
+	}
+	free(buffer);
+	if (!success)
+		free_dining_table(dining_table);
+	return (success);
+}
@@ -0,0 +1,200 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   topology_coloring.c                                :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: antestem <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/07/11 16:58:17 by antestem          #+#    #+#             */
+/*   Updated: 2024/07/11 16:58:18 by antestem         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "philosophers.h"
+
+/* build_fork_users:
+ *   Builds the list of philosophers using each fork, stored as one
+ *   contiguous array: the users of fork f are found between
+ *   fork_user_start[f] and fork_user_start[f + 1].
+ *
+ *   Parameters:
+ *     - topology: Pointer to the topology with parsed edges.
+ *
+ *   Returns:
+ *     - A boolean indicating whether the allocations succeeded.
+ */
+static bool	build_fork_users(t_topology *topology)
+{
+	unsigned int	*next_slot;
+	unsigned int	i;
+
+	topology->fork_user_start = calloc(topology->num_forks + 1,
+			sizeof(unsigned int));
+	topology->fork_users = malloc(sizeof(unsigned int) * topology->num_edges);
+	next_slot = malloc(sizeof(unsigned int) * (topology->num_forks + 1));
+	if (!topology->fork_user_start || !topology->fork_users || !next_slot)
+	{
+		free(next_slot);
+		return (print_message(ERROR_MEMORY_ALLOCATION, NULL, false));
+	}
+	i = 0;
+	while (i < topology->num_edges)
+		topology->fork_user_start[topology->edge_fork[i++] + 1]++;
+	i = 0;
+	while (i++ < topology->num_forks)
+		topology->fork_user_start[i] += topology->fork_user_start[i - 1];
+	memcpy(next_slot, topology->fork_user_start,
+		sizeof(unsigned int) * (topology->num_forks + 1));
+	i = 0;
+	while (i++ < topology->num_edges)
+		topology->fork_users[next_slot[topology->edge_fork[i - 1]]++]
+			= topology->edge_philosopher[i - 1];
+	free(next_slot);
+	return (true);
+}
+
+/* sort_forks_by_degree:
+ *   Lists the forks from the most shared to the least shared. Coloring
+ *   the busiest forks first tends to use fewer colors, which keeps the
+ *   chains of philosophers waiting on each other short.
+ *
+ *   Parameters:
+ *     - topology: Pointer to the topology with its fork users built.
+ *
+ *   Returns:
+ *     - An allocated array of fork numbers, or NULL on error.
+ */
+static unsigned int	*sort_forks_by_degree(t_topology *topology)
+{
+	unsigned int	*order;
+	unsigned int	*slot;
+	unsigned int	*start;
+	unsigned int	i;
+
+	start = topology->fork_user_start;
+	order = malloc(sizeof(unsigned int) * (topology->num_forks + 1));
+	slot = calloc(topology->num_edges + 2, sizeof(unsigned int));
+	if (!order || !slot)
+	{
+		free(slot);
+		free(order);
+		return (NULL);
+	}
+	i = 0;
+	while (i++ < topology->num_forks)
+		slot[topology->num_edges - (start[i] - start[i - 1]) + 1]++;
+	i = 0;
+	while (i++ <= topology->num_edges)
+		slot[i] += slot[i - 1];
+	i = 0;
+	while (i++ < topology->num_forks)
+		order[slot[topology->num_edges - (start[i] - start[i - 1])]++] = i - 1;
+	free(slot);
+	return (order);
+}
+
+/* color_fork:
+ *   Gives a fork the lowest color that is not already used by another
+ *   fork needed by one of the philosophers sharing it.
+ *
+ *   Parameters:
+ *     - topology: Pointer to the topology being colored.
+ *     - dining_table: Pointer to the dining_table structure.
+ *     - fork: The fork to color.
+ *     - seen: Scratch array marking the colors taken around the fork.
+ */
+static void	color_fork(t_topology *topology, t_dining_table *dining_table,
+		unsigned int fork, unsigned int *seen)
+{
+	t_philosopher	*philosopher;
+	unsigned int	i;
+	unsigned int	j;
+	int				color;
+
+	i = topology->fork_user_start[fork];
+	while (i < topology->fork_user_start[fork + 1])
+	{
+		philosopher = dining_table->philosophers[topology->fork_users[i]];
+		j = 0;
+		while (j < philosopher->num_forks)
+		{
+			color = topology->fork_color[philosopher->forks[j++]];
+			if (color >= 0)
+				seen[color] = fork + 1;
+		}
+		i++;
+	}
+	color = 0;
+	while (seen[color] == fork + 1)
+		color++;
+	topology->fork_color[fork] = color;
+}
+
+/* color_forks:
+ *   Colors the forks greedily so that no philosopher needs two forks
+ *   of the same color.
+ *
+ *   Parameters:
+ *     - topology: Pointer to the topology with parsed edges.
+ *     - dining_table: Pointer to the dining_table structure.
+ *
+ *   Returns:
+ *     - A boolean indicating whether the coloring succeeded.
+ */
+bool	color_forks(t_topology *topology, t_dining_table *dining_table)
+{
+	unsigned int	*order;
+	unsigned int	*seen;
+	unsigned int	i;
+
+	if (!build_fork_users(topology))
+		return (false);
+	topology->fork_color = malloc(sizeof(int) * topology->num_forks);
+	seen = calloc(topology->num_forks + 1, sizeof(unsigned int));
+	order = sort_forks_by_degree(topology);
+	if (!topology->fork_color || !seen || !order)
+	{
+		free(seen);
+		free(order);
+		return (print_message(ERROR_MEMORY_ALLOCATION, NULL, false));
+	}
+	i = 0;
+	while (i < topology->num_forks)
+		topology->fork_color[i++] = -1;
+	i = 0;
+	while (i < topology->num_forks)
+		color_fork(topology, dining_table, order[i++], seen);
+	free(seen);
+	free(order);
+	return (true);
+}
+
+/* order_forks_by_color:
+ *   Sorts a philosopher's resource set by increasing fork color, which
+ *   is the order in which the forks will be taken.
+ *
+ *   Parameters:
+ *     - philosopher: Pointer to the philosopher structure.
+ *     - fork_color: The color of each fork.
+ */
+void	order_forks_by_color(t_philosopher *philosopher, int *fork_color)
+{
+	unsigned int	i;
+	unsigned int	j;
+	unsigned int	fork;
+
+	i = 1;
+	while (i < philosopher->num_forks)
+	{
+		fork = philosopher->forks[i];
+		j = i;
+		while (j > 0 && fork_color[philosopher->forks[j - 1]]
+			> fork_color[fork])
+		{
+			philosopher->forks[j] = philosopher->forks[j - 1];
+			j--;
+		}
+		philosopher->forks[j] = fork;
+		i++;
+	}
+}
@@ -0,0 +1,155 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   topology_graph.c                                   :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: antestem <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/07/11 16:58:10 by antestem          #+#    #+#             */
+/*   Updated: 2024/07/11 16:58:11 by antestem         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "philosophers.h"
+
+/* add_fork_to_philosopher:
+ *   Adds a fork to a philosopher's resource set, unless the edge list
+ *   already listed it for this philosopher.
+ *
+ *   Parameters:
+ *     - philosopher: Pointer to the philosopher structure.
+ *     - fork: The fork to add.
+ */
+static void	add_fork_to_philosopher(t_philosopher *philosopher,
+		unsigned int fork)
+{
+	unsigned int	i;
+
+	i = 0;
+	while (i < philosopher->num_forks)
+	{
+		if (philosopher->forks[i] == fork)
+			return ;
+		i++;
+	}
+	philosopher->forks[philosopher->num_forks++] = fork;
+}
+
+/* prepare_fork_set:
+ *   Replaces a philosopher's default pair of forks with an empty
+ *   resource set large enough for every edge the topology lists for
+ *   them. Every philosopher must need at least one fork.
+ *
+ *   Parameters:
+ *     - philosopher: Pointer to the philosopher structure.
+ *     - edge_count: The number of edges listing this philosopher.
+ *
+ *   Returns:
+ *     - A boolean indicating whether the resource set was allocated.
+ */
+static bool	prepare_fork_set(t_philosopher *philosopher,
+		unsigned int edge_count)
+{
+	if (edge_count == 0)
+		return (print_message(ERROR_TOPOLOGY_FORMAT,
+				"every philosopher needs at least one fork", false));
+	table_free(philosopher->dining_table, philosopher->forks);
+	table_free(philosopher->dining_table, philosopher->fork_nodes);
+	philosopher->num_forks = 0;
+	philosopher->forks = table_alloc(philosopher->dining_table,
+			sizeof(unsigned int) * edge_count, _Alignof(unsigned int));
+	philosopher->fork_nodes = table_alloc(philosopher->dining_table,
+			sizeof(t_fork_node) * edge_count, _Alignof(t_fork_node));
+	if (!philosopher->forks || !philosopher->fork_nodes)
+		return (print_message(ERROR_MEMORY_ALLOCATION, NULL, false));
+	return (true);
+}
+
+/* assign_philosopher_forks:
+ *   Gives every philosopher the resource set described by the topology.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ *     - topology: Pointer to the topology with parsed edges.
+ *
+ *   Returns:
+ *     - A boolean indicating whether every philosopher got forks.
+ */
+static bool	assign_philosopher_forks(t_dining_table *dining_table,
+		t_topology *topology)
+{
+	unsigned int	*edge_count;
+	unsigned int	i;
+
+	edge_count = calloc(dining_table->num_philosophers, sizeof(unsigned int));
+	if (!edge_count)
+		return (print_message(ERROR_MEMORY_ALLOCATION, NULL, false));
+	i = 0;
+	while (i < topology->num_edges)
+		edge_count[topology->edge_philosopher[i++]]++;
+	i = 0;
+	while (i < dining_table->num_philosophers
+		&& prepare_fork_set(dining_table->philosophers[i], edge_count[i]))
+		i++;
+	free(edge_count);
+	if (i < dining_table->num_philosophers)
+		return (false);
+	i = 0;
+	while (i < topology->num_edges)
+	{
+		add_fork_to_philosopher(dining_table->philosophers[topology->\
+		edge_philosopher[i]], topology->edge_fork[i]);
+		i++;
+	}
+	return (true);
+}
+
+/* apply_topology:
+ *   Gives each philosopher the resource set described by the topology,
+ *   then colors the forks so that no philosopher needs two forks of the
+ *   same color, and sorts every resource set by color. Since each
+ *   philosopher takes their forks in strictly increasing color order,
+ *   no chain of philosophers waiting on each other can loop back on
+ *   itself, and the table cannot deadlock.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ *     - topology: Pointer to the topology with parsed edges.
+ *
+ *   Returns:
+ *     - A boolean indicating whether the topology was applied.
+ */
+bool	apply_topology(t_dining_table *dining_table, t_topology *topology)
+{
+	unsigned int	i;
+
+	if (!assign_philosopher_forks(dining_table, topology))
+		return (false);
+	if (!color_forks(topology, dining_table))
+		return (false);
+	i = 0;
+	while (i < dining_table->num_philosophers)
+	{
+		order_forks_by_color(dining_table->philosophers[i],
+			topology->fork_color);
+		i++;
+	}
+	dining_table->num_forks = topology->num_forks;
+	return (true);
+}
+
+/* free_topology:
+ *   Frees the memory used to load a topology. The resource sets
+ *   given to the philosophers belong to them and are not freed here.
+ *
+ *   Parameters:
+ *     - topology: Pointer to the topology to free.
+ */
+void	free_topology(t_topology *topology)
+{
+	free(topology->edge_philosopher);
+	free(topology->edge_fork);
+	free(topology->fork_user_start);
+	free(topology->fork_users);
+	free(topology->fork_color);
+}
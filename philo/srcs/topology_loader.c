@@ -0,0 +1,168 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   topology_loader.c                                  :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: antestem <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/07/11 16:58:02 by antestem          #+#    #+#             */
+/*   Updated: 2024/07/11 16:58:03 by antestem         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "philosophers.h"
+
+/* next_number:
+ *   Skips whitespace and '#' comments, then reads the next unsigned
+ *   number of an edge list or timings file and moves the cursor past it.
+ *
+ *   Parameters:
+ *     - cursor: Pointer to the current position in the buffer.
+ *     - value: Where to store the number that was read.
+ *
+ *   Returns:
+ *     - 1 if a number was read, 0 at the end of the buffer, or -1 if
+ *       an unexpected character or a number above INT_MAX was found.
+ */
+int	next_number(char **cursor, unsigned int *value)
+{
+	char	*str;
+
+	str = *cursor;
+	while (*str == ' ' || (*str >= '\t' && *str <= '\r') || *str == '#')
+	{
+		if (*str == '#')
+			while (*str && *str != '\n')
+				str++;
+		else
+			str++;
+	}
+	*cursor = str;
+	if (*str == '\0')
+		return (0);
+	if (*str < '0' || *str > '9' || parse_integer(str) == -1)
+		return (-1);
+	*value = parse_integer(str);
+	while (*str >= '0' && *str <= '9')
+		str++;
+	*cursor = str;
+	return (1);
+}
+
+/* count_edges:
+ *   Counts the numbers in the edge list to find out how many
+ *   "<philosopher> <fork>" pairs it describes.
+ *
+ *   Parameters:
+ *     - topology: Pointer to the topology to store the edge count in.
+ *     - buffer: The contents of the edge list file.
+ *
+ *   Returns:
+ *     - A boolean indicating whether the edge list is well-formed.
+ */
+static bool	count_edges(t_topology *topology, char *buffer)
+{
+	unsigned int	count;
+	unsigned int	value;
+	int				status;
+
+	count = 0;
+	status = next_number(&buffer, &value);
+	while (status == 1)
+	{
+		count++;
+		status = next_number(&buffer, &value);
+	}
+	if (status == -1)
+		return (print_message(ERROR_TOPOLOGY_FORMAT,
+				"expected unsigned integers only", false));
+	if (count == 0 || count % 2)
+		return (print_message(ERROR_TOPOLOGY_FORMAT,
+				"expected \"<philosopher> <fork>\" pairs", false));
+	topology->num_edges = count / 2;
+	return (true);
+}
+
+/* parse_edges:
+ *   Fills the topology's edge arrays from the edge list. Philosophers
+ *   are numbered from 1, as in the simulation output, and forks from 0,
+ *   as in the debug output. The number of forks on the table is one more
+ *   than the highest fork number used.
+ *
+ *   Parameters:
+ *     - topology: Pointer to the topology with allocated edge arrays.
+ *     - buffer: The contents of the edge list file.
+ *     - num_philosophers: The number of philosophers at the table.
+ *
+ *   Returns:
+ *     - A boolean indicating whether every edge is within range.
+ */
+static bool	parse_edges(t_topology *topology, char *buffer,
+		unsigned int num_philosophers)
+{
+	unsigned int	i;
+	unsigned int	philosopher;
+
+	i = 0;
+	while (i < topology->num_edges)
+	{
+		next_number(&buffer, &philosopher);
+		next_number(&buffer, &topology->edge_fork[i]);
+		if (philosopher < 1 || philosopher > num_philosophers)
+			return (print_message(ERROR_TOPOLOGY_FORMAT,
+					"philosopher number out of range", false));
+		if (topology->edge_fork[i] >= MAX_FORKS)
+			return (print_message(ERROR_TOPOLOGY_FORMAT,
+					"fork numbers must be below " STR_MAX_FORKS, false));
+		topology->edge_philosopher[i] = philosopher - 1;
+		if (topology->edge_fork[i] >= topology->num_forks)
+			topology->num_forks = topology->edge_fork[i] + 1;
+		i++;
+	}
+	return (true);
+}
+
+/* load_topology:
+ *   Reads an edge list file describing which forks each philosopher
+ *   needs in order to eat, and replaces the default ring of forks with
+ *   it. Each line holds one "<philosopher> <fork>" pair and '#' starts
+ *   a comment. Frees the dining table if the topology is invalid.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ *     - path: The path of the edge list file.
+ *
+ *   Returns:
+ *     - A boolean indicating whether the topology was applied.
+ */
+bool	load_topology(t_dining_table *dining_table, char *path)
+{
+	t_topology	topology;
+	char		*buffer;
+	bool		success;
+
+	memset(&topology, 0, sizeof(t_topology));
+	buffer = read_text_file(path);
+	if (!buffer)
+		return (print_error_and_exit(ERROR_TOPOLOGY_FILE, path,
+				dining_table));
+	success = count_edges(&topology, buffer);
+	if (success)
+	{
+		topology.edge_philosopher = malloc(sizeof(unsigned int)
+				* topology.num_edges);
+		topology.edge_fork = malloc(sizeof(unsigned int) * topology.num_edges);
+		if (!topology.edge_philosopher || !topology.edge_fork)
+			success = print_message(ERROR_MEMORY_ALLOCATION, NULL, false);
+	}
+	if (success)
+		success = parse_edges(&topology, buffer,
+				dining_table->num_philosophers);
+	free(buffer);
+	if (success)
+		success = apply_topology(dining_table, &topology);
+	free_topology(&topology);
+	if (!success)
+		free_dining_table(dining_table);
+	return (success);
+}
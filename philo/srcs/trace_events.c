@@ -0,0 +1,146 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   trace_events.c                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: antestem <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/07/11 16:59:19 by antestem          #+#    #+#             */
+/*   Updated: 2024/07/11 16:59:20 by antestem         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "philosophers.h"
+
+/* elapsed_time:
+ *   Returns the time elapsed since the start of the simulation in
+ *   milliseconds, as stored in trace events.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ */
+static uint32_t	elapsed_time(t_dining_table *dining_table)
+{
+	return (get_current_time_in_ms() - dining_table->start_time);
+}
+
+/* leave_trace:
+ *   Stops enforcing the replayed order, either because the simulation
+ *   did something the trace does not contain or because the trace has
+ *   run out. Only the first thread to notice prints a warning.
+ *
+ *   Parameters:
+ *     - trace: Pointer to the trace structure.
+ */
+static void	leave_trace(t_trace *trace)
+{
+	if (!atomic_exchange(&trace->diverged, true))
+		print_message(WARNING_TRACE_DIVERGED, trace->path, 0);
+}
+
+/* trace_before:
+ *   When replaying, holds the philosopher back until the next event of
+ *   the trace is this one and its recorded time has been reached. Every
+ *   other thread waits for its own turn in the meantime, which forces the
+ *   recorded interleaving of fork acquisitions and wakeups. A death is
+ *   left for the grim reaper to replay, even the philosopher's own. Does
+ *   nothing when not replaying.
+ *
+ *   Parameters:
+ *     - philosopher: Pointer to the philosopher about to act.
+ *     - kind: TRACE_FORK before taking a fork, TRACE_WAKEUP before
+ *       returning from philosopher_sleep.
+ *     - slot: The position of the fork in the philosopher's resource set.
+ */
+void	trace_before(t_philosopher *philosopher, t_trace_kind kind,
+		unsigned int slot)
+{
+	t_trace			*trace;
+	t_trace_event	*event;
+	size_t			turn;
+
+	trace = &philosopher->dining_table->trace;
+	if (trace->mode != TRACE_REPLAY)
+		return ;
+	while (!atomic_load(&trace->diverged)
+		&& !is_simulation_stopped(philosopher->dining_table))
+	{
+		turn = atomic_load_explicit(&trace->next, memory_order_acquire);
+		event = &trace->events[turn];
+		if (turn >= trace->header->num_events
+			|| (event->philosopher == philosopher->id
+				&& event->kind != TRACE_DIED
+				&& (event->kind != kind || event->slot != (uint8_t)slot)))
+		{
+			leave_trace(trace);
+			return ;
+		}
+		if (event->philosopher == philosopher->id && event->kind != TRACE_DIED
+			&& elapsed_time(philosopher->dining_table) >= event->time)
+			return ;
+		usleep(TRACE_REPLAY_POLL_US);
+	}
+}
+
+/* trace_after:
+ *   When recording, appends the event that just happened to the trace.
+ *   Each event takes one atomic increment and one 8-byte store into the
+ *   mapped trace file. When replaying, passes the turn to the next event.
+ *
+ *   Parameters:
+ *     - philosopher: Pointer to the philosopher who acted.
+ *     - kind: The kind of event.
+ *     - slot: The position of the fork in the philosopher's resource set.
+ */
+void	trace_after(t_philosopher *philosopher, t_trace_kind kind,
+		unsigned int slot)
+{
+	t_trace	*trace;
+	size_t	index;
+
+	trace = &philosopher->dining_table->trace;
+	if (trace->mode == TRACE_REPLAY && !atomic_load(&trace->diverged))
+		atomic_fetch_add_explicit(&trace->next, 1, memory_order_release);
+	if (trace->mode != TRACE_RECORD)
+		return ;
+	index = atomic_fetch_add_explicit(&trace->next, 1, memory_order_relaxed);
+	if (index >= trace->capacity)
+		return ;
+	trace->events[index].philosopher = philosopher->id;
+	trace->events[index].kind = kind;
+	trace->events[index].slot = slot;
+	trace->events[index].time = elapsed_time(philosopher->dining_table);
+}
+
+/* trace_next_death:
+ *   When replaying, checks whether the next event of the trace is a
+ *   death whose recorded time has been reached. The grim reaper uses it
+ *   to kill the same philosopher as in the recorded run, at the same
+ *   point of the interleaving.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ *
+ *   Returns:
+ *     - A pointer to the philosopher who must die now, or NULL.
+ */
+t_philosopher	*trace_next_death(t_dining_table *dining_table)
+{
+	t_trace			*trace;
+	t_trace_event	*event;
+	size_t			turn;
+
+	trace = &dining_table->trace;
+	if (trace->mode != TRACE_REPLAY || atomic_load(&trace->diverged))
+		return (NULL);
+	turn = atomic_load_explicit(&trace->next, memory_order_acquire);
+	if (turn >= trace->header->num_events)
+		return (NULL);
+	event = &trace->events[turn];
+	if (event->kind != TRACE_DIED
+		|| event->philosopher >= dining_table->num_philosophers
+		|| elapsed_time(dining_table) < event->time)
+		return (NULL);
+	atomic_fetch_add_explicit(&trace->next, 1, memory_order_release);
+	return (dining_table->philosophers[event->philosopher]);
+}
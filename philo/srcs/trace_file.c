@@ -0,0 +1,176 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   trace_file.c                                       :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: antestem <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/07/11 16:59:11 by antestem          #+#    #+#             */
+/*   Updated: 2024/07/11 16:59:12 by antestem         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "philosophers.h"
+
+/* fill_trace_header:
+ *   Writes the simulation parameters at the start of a new trace file,
+ *   so that a replay can check it runs with the same ones.
+ *
+ *   Parameters:
+ *     - header: Pointer to the mapped trace header.
+ *     - dining_table: Pointer to the dining_table structure.
+ */
+static void	fill_trace_header(t_trace_header *header,
+		t_dining_table *dining_table)
+{
+	header->magic = TRACE_MAGIC;
+	header->version = TRACE_VERSION;
+	header->num_philosophers = dining_table->num_philosophers;
+	header->num_forks = dining_table->num_forks;
+	header->must_eat_count = dining_table->must_eat_count;
+	header->time_to_die = dining_table->time_to_die;
+	header->time_to_eat = dining_table->time_to_eat;
+	header->time_to_sleep = dining_table->time_to_sleep;
+	header->num_events = 0;
+}
+
+/* open_trace_for_recording:
+ *   Creates the trace file with room for TRACE_CAPACITY events and maps
+ *   it into memory. Recording an event is then a plain store into the
+ *   mapping: the kernel writes the pages back in the background, and
+ *   pages that are never touched take no space on disk.
+ *
+ *   Parameters:
+ *     - trace: Pointer to the trace structure.
+ *     - dining_table: Pointer to the dining_table structure.
+ *
+ *   Returns:
+ *     - A boolean indicating whether the file was created and mapped.
+ */
+static bool	open_trace_for_recording(t_trace *trace,
+		t_dining_table *dining_table)
+{
+	size_t	size;
+	void	*mapping;
+
+	trace->capacity = TRACE_CAPACITY;
+	size = sizeof(t_trace_header) + sizeof(t_trace_event) * trace->capacity;
+	trace->fd = open(trace->path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (trace->fd < 0 || ftruncate(trace->fd, size) != 0)
+		return (false);
+	mapping = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+			trace->fd, 0);
+	if (mapping == MAP_FAILED)
+		return (false);
+	trace->header = mapping;
+	trace->events = (t_trace_event *)(trace->header + 1);
+	fill_trace_header(trace->header, dining_table);
+	return (true);
+}
+
+/* open_trace_for_replay:
+ *   Maps an existing trace file into memory for reading.
+ *
+ *   Parameters:
+ *     - trace: Pointer to the trace structure.
+ *
+ *   Returns:
+ *     - A boolean indicating whether the file was opened and mapped.
+ */
+static bool	open_trace_for_replay(t_trace *trace)
+{
+	struct stat	file_info;
+	void		*mapping;
+
+	trace->fd = open(trace->path, O_RDONLY);
+	if (trace->fd < 0 || fstat(trace->fd, &file_info) != 0
+		|| (size_t)file_info.st_size < sizeof(t_trace_header))
+		return (false);
+	mapping = mmap(NULL, file_info.st_size, PROT_READ, MAP_PRIVATE,
+			trace->fd, 0);
+	if (mapping == MAP_FAILED)
+		return (false);
+	trace->header = mapping;
+	trace->events = (t_trace_event *)(trace->header + 1);
+	trace->capacity = (file_info.st_size - sizeof(t_trace_header))
+		/ sizeof(t_trace_event);
+	return (true);
+}
+
+/* open_trace:
+ *   Opens a trace file to record the order of fork acquisitions and
+ *   wakeups into, or to replay that order from. A replayed trace must
+ *   have been recorded with the same parameters and number of forks.
+ *   Frees the dining table if the trace file cannot be used.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ *     - mode: TRACE_RECORD or TRACE_REPLAY.
+ *     - path: The path of the trace file.
+ *
+ *   Returns:
+ *     - A boolean indicating whether the trace file is ready.
+ */
+bool	open_trace(t_dining_table *dining_table, t_trace_mode mode, char *path)
+{
+	t_trace			*trace;
+	t_trace_header	expected;
+	bool			success;
+
+	trace = &dining_table->trace;
+	trace->mode = mode;
+	trace->path = path;
+	trace->fd = -1;
+	atomic_init(&trace->next, 0);
+	atomic_init(&trace->diverged, false);
+	if (mode == TRACE_RECORD)
+		success = open_trace_for_recording(trace, dining_table);
+	else
+		success = open_trace_for_replay(trace);
+	if (!success)
+		return (print_error_and_exit(ERROR_TRACE_FILE, path, dining_table));
+	fill_trace_header(&expected, dining_table);
+	expected.num_events = trace->header->num_events;
+	if (mode == TRACE_REPLAY && (memcmp(&expected, trace->header,
+				sizeof(t_trace_header)) != 0
+			|| trace->header->num_events > trace->capacity))
+		return (print_error_and_exit(ERROR_TRACE_MISMATCH, path,
+				dining_table));
+	return (true);
+}
+
+/* close_trace:
+ *   Unmaps and closes the trace file. When recording, stores the number
+ *   of recorded events in the header and trims the file to its used
+ *   size, warning if some events did not fit.
+ *
+ *   Parameters:
+ *     - trace: Pointer to the trace structure.
+ */
+void	close_trace(t_trace *trace)
+{
+	size_t	used;
+
+	if (trace->mode == TRACE_OFF)
+		return ;
+	used = sizeof(t_trace_header);
+	if (trace->header && trace->mode == TRACE_RECORD)
+	{
+		trace->header->num_events = atomic_load(&trace->next);
+		if (trace->header->num_events > trace->capacity)
+		{
+			print_message(WARNING_TRACE_FULL, trace->path, 0);
+			trace->header->num_events = trace->capacity;
+		}
+		used += sizeof(t_trace_event) * trace->header->num_events;
+	}
+	if (trace->header)
+		munmap(trace->header, sizeof(t_trace_header)
+			+ sizeof(t_trace_event) * trace->capacity);
+	if (trace->fd >= 0 && trace->mode == TRACE_RECORD)
+		if (ftruncate(trace->fd, used) != 0)
+			print_message(ERROR_TRACE_FILE, trace->path, 0);
+	if (trace->fd >= 0)
+		close(trace->fd);
+	trace->mode = TRACE_OFF;
+}
@@ -0,0 +1,99 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   utils.c                                            :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: antestem <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/07/11 16:59:43 by antestem          #+#    #+#             */
+/*   Updated: 2024/07/11 16:59:44 by antestem         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "philosophers.h"
+
+/* read_text_file:
+ *   Reads a whole text file, such as a topology or config file, into a
+ *   null-terminated buffer.
+ *
+ *   Parameters:
+ *     - path: The path of the file.
+ *
+ *   Returns:
+ *     - The allocated buffer, or NULL if the file could not be read.
+ */
+char	*read_text_file(char *path)
+{
+	int			fd;
+	struct stat	file_info;
+	char		*buffer;
+	ssize_t		bytes_read;
+	size_t		total;
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return (NULL);
+	buffer = NULL;
+	if (fstat(fd, &file_info) == 0)
+		buffer = malloc(file_info.st_size + 1);
+	total = 0;
+	bytes_read = 1;
+	while (buffer && bytes_read > 0 && total < (size_t)file_info.st_size)
+	{
+		bytes_read = read(fd, buffer + total, file_info.st_size - total);
+		if (bytes_read > 0)
+			total += bytes_read;
+	}
+	close(fd);
+	if (buffer)
+		buffer[total] = '\0';
+	return (buffer);
+}
+
+/* trim_whitespace:
+ *   Removes the spaces and tabs around a string, in place.
+ *
+ *   Parameters:
+ *     - str: The string to trim.
+ *
+ *   Returns:
+ *     - A pointer to the first non-blank character of the string.
+ */
+char	*trim_whitespace(char *str)
+{
+	char	*end;
+
+	while (*str == ' ' || *str == '\t' || *str == '\r')
+		str++;
+	end = str + strlen(str);
+	while (end > str && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r'))
+		end--;
+	*end = '\0';
+	return (str);
+}
+
+/* pin_thread:
+ *   Pins a thread to one CPU core, spreading the threads over the cores
+ *   in turn, when the pinning setting is "cores". Pinning is only a hint:
+ *   the simulation runs normally if it fails.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ *     - thread: The thread to pin.
+ *     - index: The index of the thread.
+ */
+void	pin_thread(t_dining_table *dining_table, pthread_t thread,
+		unsigned int index)
+{
+	cpu_set_t	cpus;
+	long		num_cpus;
+
+	if (dining_table->settings.pinning != PIN_CORES)
+		return ;
+	num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	if (num_cpus < 1)
+		return ;
+	CPU_ZERO(&cpus);
+	CPU_SET(index % num_cpus, &cpus);
+	pthread_setaffinity_np(thread, sizeof(cpu_set_t), &cpus);
+}
@@ -0,0 +1,115 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   worker_processes.c                                 :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: antestem <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/07/11 17:01:30 by antestem          #+#    #+#             */
+/*   Updated: 2024/07/11 17:01:31 by antestem         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "philosophers.h"
+#include <sys/wait.h>
+
+/* run_worker:
+ *   The body of a worker process: runs its shard of the philosophers as
+ *   threads, then exits once they all returned. The worker never
+ *   returns to main, so it does not free the table its parent owns.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ *     - first: The id of the first philosopher of the shard.
+ *     - end: The id after the last philosopher of the shard.
+ */
+static void	run_worker(t_dining_table *dining_table, unsigned int first,
+		unsigned int end)
+{
+	unsigned int	i;
+	int				status;
+
+	status = EXIT_SUCCESS;
+	i = first;
+	while (i < end)
+	{
+		if (!create_philosopher_thread(dining_table, i))
+		{
+			print_message(ERROR_THREAD_CREATION, NULL, 0);
+			set_simulation_stop_flag(dining_table, true);
+			status = EXIT_FAILURE;
+			break ;
+		}
+		pin_thread(dining_table, dining_table->philosophers[i]->thread, i);
+		i++;
+	}
+	while (i > first)
+		pthread_join(dining_table->philosophers[--i]->thread, NULL);
+	fflush(stdout);
+	_exit(status);
+}
+
+/* start_workers:
+ *   Forks the worker processes, each running an equal share of the
+ *   philosophers, in order: with as many processes as philosophers,
+ *   each one runs a single philosopher. The forks, the meal times and
+ *   the stop flag live in the shared arena, so the grim reaper and the
+ *   output thread can keep running as threads of the main process. If
+ *   a fork fails, the workers already started are stopped.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ *
+ *   Returns:
+ *     - A boolean indicating whether every worker was started.
+ */
+bool	start_workers(t_dining_table *dining_table)
+{
+	unsigned int	w;
+	unsigned int	num_workers;
+
+	num_workers = dining_table->settings.processes;
+	if (num_workers > dining_table->num_philosophers)
+		num_workers = dining_table->num_philosophers;
+	dining_table->workers = calloc(num_workers, sizeof(pid_t));
+	if (!dining_table->workers)
+		return (print_message(ERROR_MEMORY_ALLOCATION, NULL, false));
+	fflush(stdout);
+	w = 0;
+	while (w < num_workers)
+	{
+		dining_table->workers[w] = fork();
+		if (dining_table->workers[w] < 0)
+		{
+			set_simulation_stop_flag(dining_table, true);
+			wait_workers(dining_table);
+			return (print_message(ERROR_PROCESS_CREATION, NULL, false));
+		}
+		if (dining_table->workers[w] == 0)
+			run_worker(dining_table, dining_table->num_philosophers * w
+				/ num_workers, dining_table->num_philosophers * (w + 1)
+				/ num_workers);
+		dining_table->num_workers = ++w;
+	}
+	return (true);
+}
+
+/* wait_workers:
+ *   Waits for every worker process started so far to exit.
+ *
+ *   Parameters:
+ *     - dining_table: Pointer to the dining_table structure.
+ */
+void	wait_workers(t_dining_table *dining_table)
+{
+	unsigned int	w;
+
+	w = 0;
+	while (w < dining_table->num_workers)
+	{
+		while (waitpid(dining_table->workers[w], NULL, 0) < 0
+			&& errno == EINTR)
+			continue ;
+		w++;
+	}
+}